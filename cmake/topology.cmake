@@ -0,0 +1,58 @@
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Chassis, sensor and drive tables generated from the topology description.
+# Shared by the application and the unit tests.
+set(SMC_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+
+function(smc_generate_topology target)
+    set(TOPOLOGY_JSON ${SMC_SOURCE_DIR}/topology/tray.json)
+    set(TOPOLOGY_GEN_DIR ${CMAKE_CURRENT_BINARY_DIR}/topology)
+    set(TOPOLOGY_GEN_FILES
+        ${TOPOLOGY_GEN_DIR}/topology_ids.h
+        ${TOPOLOGY_GEN_DIR}/topology.h
+        ${TOPOLOGY_GEN_DIR}/topology.c
+    )
+    add_custom_command(
+        OUTPUT ${TOPOLOGY_GEN_FILES}
+        COMMAND ${PYTHON_EXECUTABLE}
+                ${SMC_SOURCE_DIR}/scripts/gen_topology.py
+                --input ${TOPOLOGY_JSON}
+                --output-dir ${TOPOLOGY_GEN_DIR}
+        DEPENDS ${TOPOLOGY_JSON} ${SMC_SOURCE_DIR}/scripts/gen_topology.py
+        COMMENT "Generating topology tables"
+    )
+    target_sources(${target} PRIVATE ${TOPOLOGY_GEN_FILES})
+    target_include_directories(${target} PRIVATE ${TOPOLOGY_GEN_DIR})
+endfunction()
+
+# Only the chassis, sensor and drive enums, for the unit tests of modules that
+# index their tables by sensor id. The tables in topology.c need the full
+# application configuration and smc-common.
+function(smc_generate_topology_ids target)
+    set(TOPOLOGY_JSON ${SMC_SOURCE_DIR}/topology/tray.json)
+    set(TOPOLOGY_GEN_DIR ${CMAKE_CURRENT_BINARY_DIR}/topology)
+    add_custom_command(
+        OUTPUT ${TOPOLOGY_GEN_DIR}/topology_ids.h
+        COMMAND ${PYTHON_EXECUTABLE}
+                ${SMC_SOURCE_DIR}/scripts/gen_topology.py
+                --input ${TOPOLOGY_JSON}
+                --output-dir ${TOPOLOGY_GEN_DIR}
+                --ids-only
+        DEPENDS ${TOPOLOGY_JSON} ${SMC_SOURCE_DIR}/scripts/gen_topology.py
+        COMMENT "Generating topology ids"
+    )
+    target_sources(${target} PRIVATE ${TOPOLOGY_GEN_DIR}/topology_ids.h)
+    target_include_directories(${target} PRIVATE ${TOPOLOGY_GEN_DIR})
+endfunction()
@@ -0,0 +1,399 @@
+#!/usr/bin/env python3
+# Copyright 2025 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generate the platform topology tables from a JSON description.
+
+Outputs, in the output directory:
+  topology_ids.h  chassis, sensor and drive enums (included by platform_cfg.h)
+  topology.h      declarations of the generated tables
+  topology.c      const tables, with every string interned in one pool
+"""
+
+import argparse
+import json
+import os
+import sys
+
+HEADER = """/*
+ * Generated by scripts/gen_topology.py from {source}. Do not edit.
+ */
+"""
+
+
+class StringPool:
+    """Interns strings into a single NUL separated char array.
+
+    Identical strings are stored once, and a string that is the tail of a
+    longer one (e.g. "Temp" and ".../Sensors/Temp") points into it.
+    """
+
+    def __init__(self):
+        self.strings = set()
+        self.offsets = None
+        self.blob = []
+
+    def add(self, s):
+        self.strings.add(s)
+        return s
+
+    def build(self):
+        self.offsets = {}
+        size = 0
+        placed = []
+        for s in sorted(self.strings, key=lambda x: (-len(x), x)):
+            for base, offset in placed:
+                if base.endswith(s):
+                    self.offsets[s] = offset + len(base) - len(s)
+                    break
+            else:
+                self.offsets[s] = size
+                placed.append((s, size))
+                self.blob.append(s)
+                size += len(s) + 1
+        self.size = size
+
+    def ref(self, s):
+        return "&topology_strings[{}] /* \"{}\" */".format(self.offsets[s], s)
+
+    def emit(self):
+        lines = ["static const char topology_strings[{}] =".format(self.size)]
+        lines += ['    "{}\\0"'.format(s) for s in self.blob]
+        lines[-1] += ";"
+        return "\n".join(lines)
+
+
+def load(path):
+    with open(path) as f:
+        topo = json.load(f)
+
+    tray = topo["tray"]
+    drives = topo["drives"]
+    count = drives["count"]
+    bus = drives["protocol"]
+
+    sensors = []
+    for s in tray["sensors"]:
+        sensors.append(dict(s, chassis=tray["enum"],
+                            odata_id="{}/Sensors/{}".format(tray["odata_id"],
+                                                            s["uri"])))
+
+    temp = drives["temp"]
+    initial = temp["initial"]
+    if isinstance(initial, list) and len(initial) != count:
+        sys.exit("{}: drives.temp.initial has {} entries for {} drives".format(
+            path, len(initial), count))
+    hdd = []
+    for i in range(count):
+        name = "{}_{}".format(bus, i)
+        chassis = "/redfish/v1/Chassis/" + name
+        hdd.append({
+            "index": i,
+            "name": name,
+            "chassis": chassis,
+            "service_label": drives["service_label"].format(i=i),
+            "drive": "{}/Drives/{}".format(chassis, name),
+            "sensor": {
+                "enum": "HDD{}_TEMP".format(i),
+                "chassis": name,
+                "odata_id": chassis + "/Sensors/Temp",
+                "id": "Temp",
+                "reading_type": "TEMPERATURE",
+                "dummy": {
+                    "name": temp["name"].format(i=i),
+                    "max": temp["max"],
+                    "min": temp["min"],
+                    "unit": temp["unit"],
+                    "initial": (initial[i] if isinstance(initial, list)
+                                else initial),
+                },
+            },
+        })
+        if "threshold" in temp:
+            hdd[-1]["sensor"]["threshold"] = temp["threshold"]
+    sensors += [d["sensor"] for d in hdd]
+    return topo, sensors, hdd
+
+
+def gen_ids(topo, sensors, hdd, source):
+    out = [HEADER.format(source=source),
+           "#ifndef TOPOLOGY_IDS_H_", "#define TOPOLOGY_IDS_H_", ""]
+
+    out += ["enum rde_chassis_id", "{",
+            "    RDE_CHASSIS_{} = 0,".format(topo["tray"]["enum"])]
+    out += ["    RDE_CHASSIS_{},".format(d["name"]) for d in hdd]
+    out += ["", "    // Number of possible chassis for the platform.",
+            "    RDE_CHASSIS_N,", "};", ""]
+
+    out += ["/**", " * @brief Sensor enums.", " *",
+            " * Only the sensors supported by redfish are listed. Every member"
+            " gets storage",
+            " * for the redfish representation of the sensor.", " */",
+            "enum smc_sensor_id", "{"]
+    for i, s in enumerate(sensors):
+        out.append("    SMC_SENSOR_{}{},".format(s["enum"],
+                                                 " = 0" if i == 0 else ""))
+    out += ["", "    // Number of possible sensors on the platform.",
+            "    SMC_SENSOR_N,", "};", ""]
+
+    out += ["enum smc_drive_id", "{"]
+    for d in hdd:
+        out.append("    SMC_DRIVE_ID_{}{},".format(
+            d["index"], " = 0" if d["index"] == 0 else ""))
+    out += ["", "    SMC_DRIVE_N", "};", "",
+            "#endif /* TOPOLOGY_IDS_H_ */", ""]
+    return "\n".join(out)
+
+
+def gen_header(source):
+    return "\n".join([HEADER.format(source=source), """#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include "sensor_event.h"
+#include "topology_ids.h"
+
+#include <smc/rde/helper.h>
+#include <smc/sensor.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A sensor with no device behind it, registered with a fixed value.
+ */
+struct topology_dummy_sensor
+{
+    uint32_t sensor_id;
+    const char* name;
+    float max;
+    float min;
+    enum smc_unit unit;
+    float initial;
+};
+
+// Kept in flash. The smc-common helpers take writable resources, so
+// rde_resources.c registers them from RAM copies.
+extern const struct redfish_chassis topology_tray_chassis;
+extern const struct redfish_chassis topology_hdd_chassis[SMC_DRIVE_N];
+extern const struct redfish_sensor topology_tray_sensors[];
+extern const struct redfish_sensor topology_hdd_sensors[SMC_DRIVE_N];
+extern const struct redfish_drive topology_drives[SMC_DRIVE_N];
+
+extern const size_t topology_tray_sensor_count;
+
+// Temperature sensor of every drive, indexed by smc_drive_id.
+extern const uint32_t topology_hdd_temp_sensors[SMC_DRIVE_N];
+
+extern const struct topology_dummy_sensor topology_dummy_sensors[];
+extern const size_t topology_dummy_sensor_count;
+
+// Thresholds of the sensors with a "threshold" entry, reported as events.
+extern const struct sensor_threshold_cfg topology_sensor_thresholds[];
+extern const size_t topology_sensor_threshold_count;
+
+#endif /* TOPOLOGY_H_ */
+"""])
+
+
+def gen_source(topo, sensors, hdd, source):
+    pool = StringPool()
+    tray = topo["tray"]
+    manager = pool.add(topo["manager"])
+    for key in ("odata_id", "id", "name", "model", "service_label", "storage"):
+        pool.add(tray[key])
+    pool.add(tray["odata_id"] + "/Sensors")
+    pool.add(tray["odata_id"] + "/Controls")
+    for s in sensors:
+        pool.add(s["odata_id"])
+        pool.add(s["id"])
+        if "dummy" in s:
+            pool.add(s["dummy"]["name"])
+    for d in hdd:
+        for key in ("name", "chassis", "service_label", "drive"):
+            pool.add(d[key])
+        pool.add(d["chassis"] + "/Sensors")
+        pool.add(d["chassis"] + "/Drives")
+        pool.add(d["drive"] + "/Actions/Drive.Reset")
+    pool.build()
+    r = pool.ref
+
+    out = [HEADER.format(source=source), '#include "topology.h"', "",
+           '#include "platform_cfg.h"', "", "#include <sys/util.h>", "",
+           pool.emit(), ""]
+
+    out += ["const struct redfish_chassis topology_tray_chassis = {",
+            "    .chassis_id = RDE_CHASSIS_{},".format(tray["enum"]),
+            "    .contained_by_chassis_id = REDFISH_CHASSIS_ID_DO_NOT_EXIST,",
+            "    .odata_id = {},".format(r(tray["odata_id"])),
+            "    .chassis_type = REDFISH_CHASSIS_TYPE_{},".format(
+                tray["chassis_type"]),
+            "    .managed_by = {},".format(r(manager)),
+            "    .sensors_collection = {},".format(
+                r(tray["odata_id"] + "/Sensors")),
+            "    .controls_collection = {},".format(
+                r(tray["odata_id"] + "/Controls")),
+            "    .storage = {{{}}},".format(r(tray["storage"])),
+            "    .location =",
+            "        {",
+            "            .location_type = REDFISH_LOCATION_TYPE_SLOT,",
+            "            .service_label = {},".format(r(tray["service_label"])),
+            "        },",
+            "    .id = {},".format(r(tray["id"])),
+            "    .name = {},".format(r(tray["name"])),
+            "    .model = {},".format(r(tray["model"])),
+            "};", ""]
+
+    out.append("const struct redfish_chassis topology_hdd_chassis[SMC_DRIVE_N] = {")
+    for d in hdd:
+        out += ["    {",
+                "        .chassis_id = RDE_CHASSIS_{},".format(d["name"]),
+                "        .odata_id = {},".format(r(d["chassis"])),
+                "        .chassis_type = "
+                "REDFISH_CHASSIS_TYPE_STORAGEENCLOSURE,",
+                "        .id = {},".format(r(d["name"])),
+                "        .sensors_collection = {},".format(
+                    r(d["chassis"] + "/Sensors")),
+                "        .drives = {{{}}},".format(r(d["drive"])),
+                "        .hdd_index = SMC_DRIVE_ID_{},".format(d["index"]),
+                "        .drives_collection = {},".format(
+                    r(d["chassis"] + "/Drives")),
+                "        .contained_by_chassis_id = RDE_CHASSIS_{},".format(
+                    tray["enum"]),
+                "        .location =",
+                "            {",
+                "                .location_type = REDFISH_LOCATION_TYPE_SLOT,",
+                "                .service_label = {},".format(
+                    r(d["service_label"])),
+                "            },",
+                "    },"]
+    out += ["};", ""]
+
+    def sensor_entry(s):
+        return ["    {",
+                "        .chassis_id = RDE_CHASSIS_{},".format(s["chassis"]),
+                "        .sensor_id = SMC_SENSOR_{},".format(s["enum"]),
+                "        .odata_id = {},".format(r(s["odata_id"])),
+                "        .id = {},".format(r(s["id"])),
+                "        .name = {},".format(r(s["id"])),
+                "        .reading_type = REDFISH_SENSOR_READING_TYPE_{},".format(
+                    s["reading_type"]),
+                "        .related_item_odata_id = {},".format(r(manager)),
+                "    },"]
+
+    tray_sensors = [s for s in sensors if s["chassis"] == tray["enum"]]
+    out.append("const struct redfish_sensor topology_tray_sensors[] = {")
+    for s in tray_sensors:
+        out += sensor_entry(s)
+    out += ["};",
+            "const size_t topology_tray_sensor_count = "
+            "ARRAY_SIZE(topology_tray_sensors);", ""]
+
+    out.append("const struct redfish_sensor topology_hdd_sensors[SMC_DRIVE_N] = {")
+    for d in hdd:
+        out += sensor_entry(d["sensor"])
+    out += ["};", ""]
+
+    out.append("const struct redfish_drive topology_drives[SMC_DRIVE_N] = {")
+    for d in hdd:
+        out += ["    {",
+                "        .chassis_id = RDE_CHASSIS_{},".format(d["name"]),
+                "        .drive_id = SMC_DRIVE_ID_{},".format(d["index"]),
+                "        .storage_id = RDE_STORAGE_SUBSYSTEM0,",
+                "        .odata_id = {},".format(r(d["drive"])),
+                "        .media_type = REDFISH_DRIVE_MEDIA_TYPE_{},".format(
+                    topo["drives"]["media_type"]),
+                "        .protocol = REDFISH_PROTOCOL_{},".format(
+                    topo["drives"]["protocol"]),
+                "        .id = {},".format(r(d["name"])),
+                "        .name = {},".format(r(d["name"])),
+                "        .chassis_link = {},".format(r(d["chassis"])),
+                "        .reset_action =",
+                "            {",
+                "                .action_info = NULL,",
+                "                .target = {},".format(
+                    r(d["drive"] + "/Actions/Drive.Reset")),
+                "            },",
+                "    },"]
+    out += ["};", ""]
+
+    out.append("const uint32_t topology_hdd_temp_sensors[SMC_DRIVE_N] = {")
+    for d in hdd:
+        out.append("    [SMC_DRIVE_ID_{}] = SMC_SENSOR_{},".format(
+            d["index"], d["sensor"]["enum"]))
+    out += ["};", ""]
+
+    out.append("const struct topology_dummy_sensor topology_dummy_sensors[] = {")
+    for s in sensors:
+        if "dummy" not in s:
+            continue
+        dummy = s["dummy"]
+        out += ["    {",
+                "        .sensor_id = SMC_SENSOR_{},".format(s["enum"]),
+                "        .name = {},".format(r(dummy["name"])),
+                "        .max = {},".format(float(dummy["max"])),
+                "        .min = {},".format(float(dummy["min"])),
+                "        .unit = {},".format(dummy["unit"]),
+                "        .initial = {},".format(float(dummy["initial"])),
+                "    },"]
+    out += ["};",
+            "const size_t topology_dummy_sensor_count = "
+            "ARRAY_SIZE(topology_dummy_sensors);", ""]
+
+    out.append("const struct sensor_threshold_cfg "
+               "topology_sensor_thresholds[] = {")
+    for s in sensors:
+        if "threshold" not in s:
+            continue
+        threshold = s["threshold"]
+        out += ["    {",
+                "        .sensor_id = SMC_SENSOR_{},".format(s["enum"]),
+                "        .upper = {},".format(float(threshold["upper"])),
+                "        .lower = {},".format(float(threshold["lower"])),
+                "        .hysteresis = {},".format(
+                    float(threshold["hysteresis"])),
+                "    },"]
+    out += ["};",
+            "const size_t topology_sensor_threshold_count = "
+            "ARRAY_SIZE(topology_sensor_thresholds);", ""]
+    return "\n".join(out)
+
+
+def write(path, content):
+    with open(path, "w") as f:
+        f.write(content)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--input", required=True, help="topology JSON file")
+    parser.add_argument("--output-dir", required=True)
+    parser.add_argument("--ids-only", action="store_true",
+                        help="only generate topology_ids.h")
+    args = parser.parse_args()
+
+    topo, sensors, hdd = load(args.input)
+    source = os.path.basename(args.input)
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    write(os.path.join(args.output_dir, "topology_ids.h"),
+                     gen_ids(topo, sensors, hdd, source))
+    if args.ids_only:
+        return
+    write(os.path.join(args.output_dir, "topology.h"),
+                     gen_header(source))
+    write(os.path.join(args.output_dir, "topology.c"),
+                     gen_source(topo, sensors, hdd, source))
+
+
+if __name__ == "__main__":
+    main()
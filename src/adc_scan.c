@@ -0,0 +1,222 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "adc_scan.h"
+
+#include "poll_sched.h"
+#include "sensor_filter.h"
+#include "sensor_store.h"
+
+#include <device.h>
+#include <drivers/adc.h>
+#include <kernel.h>
+#include <logging/log.h>
+#include <smc/sensor.h>
+#include <smc/utils.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(adc_scan, LOG_LEVEL_WRN);
+
+#define ADC_SCAN_MAX_CHANNELS 32
+_Static_assert(ADC_SCAN_MAX_CHANNELS <= CONFIG_SMC_POLL_SCHED_BATCH_SIZE,
+               "an ADC scan group must fit in one poll batch");
+
+/**
+ * @brief All sensors of one ADC device, scanned in one sequence.
+ */
+struct adc_scan_group
+{
+    const struct device* dev;
+    struct adc_sensor_ctx* sensors[ADC_SCAN_MAX_CHANNELS];
+    uint8_t sensor_count;
+
+    struct adc_sequence sequence;
+    int32_t ref_mv;
+    uint32_t poll_rate_ms;
+
+    // Samples are stored by the driver in ascending channel order.
+    int16_t samples[ADC_SCAN_MAX_CHANNELS];
+    float readings[ADC_SCAN_MAX_CHANNELS];
+};
+
+static struct adc_scan_group groups[CONFIG_SMC_ADC_SCAN_MAX_DEVICES];
+static size_t group_count;
+
+static struct adc_scan_group* adc_scan_get_group(const struct device* dev)
+{
+    for (size_t i = 0; i < group_count; ++i)
+    {
+        if (groups[i].dev == dev)
+        {
+            return &groups[i];
+        }
+    }
+
+    if (group_count == ARRAY_SIZE(groups))
+    {
+        return NULL;
+    }
+
+    struct adc_scan_group* group = &groups[group_count++];
+    group->dev = dev;
+    group->ref_mv = adc_ref_internal(dev);
+    group->sequence.buffer = group->samples;
+    group->sequence.resolution = CONFIG_SMC_ADC_RESOLUTION;
+    group->poll_rate_ms = UINT32_MAX;
+    return group;
+}
+
+/**
+ * @brief Order the sensors of a group by channel, matching the sample order.
+ */
+static void adc_scan_sort(struct adc_scan_group* group)
+{
+    for (uint8_t i = 1; i < group->sensor_count; ++i)
+    {
+        struct adc_sensor_ctx* sensor = group->sensors[i];
+        uint8_t j = i;
+        while (j > 0 &&
+               group->sensors[j - 1]->channel_num > sensor->channel_num)
+        {
+            group->sensors[j] = group->sensors[j - 1];
+            j--;
+        }
+        group->sensors[j] = sensor;
+    }
+}
+
+static void adc_scan_poll(const uint32_t* sensors, size_t count, void* ctx)
+{
+    struct adc_scan_group* group = ctx;
+
+    int ret = adc_read(group->dev, &group->sequence);
+    if (ret != 0)
+    {
+        LOG_WRN("ADC scan failed: %d", ret);
+        for (size_t i = 0; i < count; ++i)
+        {
+            sensor_filter_reset(sensors[i]);
+            sensor_store_fail(sensors[i]);
+        }
+        return;
+    }
+
+    // Convert the whole scan first, then publish it in one go.
+    for (uint8_t i = 0; i < group->sensor_count; ++i)
+    {
+        const struct adc_sensor_ctx* sensor = group->sensors[i];
+        int32_t mv = group->samples[i];
+
+        adc_raw_to_millivolts(group->ref_mv, ADC_GAIN_1,
+                              group->sequence.resolution, &mv);
+        group->readings[i] = sensor_filter_apply(
+            sensor->id, (mv / 1000.0f) * sensor->gain + sensor->offset);
+    }
+
+    for (uint8_t i = 0; i < group->sensor_count; ++i)
+    {
+        uint32_t id = group->sensors[i]->id;
+        set_sensor_reading_float(id, group->readings[i]);
+        sensor_store_update(id, group->readings[i]);
+    }
+}
+
+static int adc_scan_add(struct adc_sensor_ctx* sensor)
+{
+    if (sensor->poll_rate_ms <= 0 || sensor->channel_num < 0 ||
+        sensor->channel_num >= ADC_SCAN_MAX_CHANNELS)
+    {
+        LOG_ERR("Invalid poll rate %d or channel %d for %s",
+                sensor->poll_rate_ms, sensor->channel_num, sensor->name);
+        return -EINVAL;
+    }
+
+    const struct device* dev = device_get_binding(sensor->dev_label);
+    if (dev == NULL)
+    {
+        LOG_ERR("ADC device %s not found", sensor->dev_label);
+        return -ENODEV;
+    }
+
+    struct adc_scan_group* group = adc_scan_get_group(dev);
+    if (group == NULL || group->sensor_count == ADC_SCAN_MAX_CHANNELS)
+    {
+        LOG_ERR("No room to scan %s", sensor->name);
+        return -ENOMEM;
+    }
+
+    // The scan returns one sample per channel, a second sensor on the same
+    // channel would never get a reading of its own.
+    if (group->sequence.channels & BIT(sensor->channel_num))
+    {
+        LOG_ERR("%s: channel %d of %s already scanned", sensor->name,
+                sensor->channel_num, sensor->dev_label);
+        return -EINVAL;
+    }
+
+    struct adc_channel_cfg channel_cfg = {
+        .gain = ADC_GAIN_1,
+        .reference = ADC_REF_INTERNAL,
+        .acquisition_time = sensor->acq_time_us,
+        .channel_id = sensor->channel_num,
+    };
+    RETURN_IF_IERROR(adc_channel_setup(dev, &channel_cfg));
+
+    // Gain and offset are applied by the scan, register the sensor without
+    // calibration.
+    RETURN_IF_IERROR(sensor_register_by_id(
+        sensor->id, dev, sensor->name, sensor->max, sensor->min,
+        /*poll_rate_ms=*/0, /*write_protect=*/true, sensor->unit,
+        /*gain=*/1, /*offset=*/0));
+
+    group->sensors[group->sensor_count++] = sensor;
+    group->sequence.channels |= BIT(sensor->channel_num);
+    group->sequence.oversampling =
+        MAX(group->sequence.oversampling, sensor->oversampling);
+    group->poll_rate_ms =
+        MIN(group->poll_rate_ms, (uint32_t)sensor->poll_rate_ms);
+    return 0;
+}
+
+int adc_scan_monitor(struct adc_sensor_ctx* sensors, size_t count)
+{
+    IS_PARAM_NULL(sensors, "sensors cannot be NULL");
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        RETURN_IF_IERROR(adc_scan_add(&sensors[i]));
+    }
+
+    for (size_t i = 0; i < group_count; ++i)
+    {
+        struct adc_scan_group* group = &groups[i];
+        uint32_t ids[ADC_SCAN_MAX_CHANNELS];
+
+        adc_scan_sort(group);
+        group->sequence.buffer_size =
+            group->sensor_count * sizeof(group->samples[0]);
+
+        // One batch per device, the whole group is read by a single scan.
+        for (uint8_t j = 0; j < group->sensor_count; ++j)
+        {
+            ids[j] = group->sensors[j]->id;
+        }
+        RETURN_IF_IERROR(poll_sched_add(ids, group->sensor_count,
+                                        group->poll_rate_ms, adc_scan_poll,
+                                        group));
+    }
+    return 0;
+}
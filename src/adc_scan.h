@@ -0,0 +1,42 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ADC_SCAN_H_
+#define ADC_SCAN_H_
+
+#include <smc/adc_sensor.h>
+#include <stddef.h>
+
+/**
+ * @brief Monitor ADC sensors with one multi-channel scan per ADC device.
+ *
+ * Drop-in replacement for adc_sensor_monitor(). Sensors sharing a dev_label
+ * are sampled together in a single read sequence, at the fastest poll_rate_ms
+ * of the group, with the largest oversampling of the group. Gain and offset
+ * are applied to the whole scan and every reading of the scan is published
+ * at once.
+ *
+ * Every sensor needs a positive poll_rate_ms, and a channel can only be used
+ * by one sensor of a device.
+ *
+ * @param sensors sensor list. Must stay valid while monitored.
+ * @param count number of sensors.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int adc_scan_monitor(struct adc_sensor_ctx* sensors, size_t count);
+
+#endif /* ADC_SCAN_H_ */
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drive_temp.h"
+
+#include "platform.h"
+#include "platform_cfg.h"
+#include "sensor_store.h"
+
+#include <float.h>
+#include <kernel.h>
+#include <smc/sensor.h>
+
+/**
+ * @brief Contiguous snapshot of all drive readings.
+ *
+ * Invalid drives hold a weight of 0 so the reductions below run without
+ * branches over the whole array. Lives in the frame of
+ * drive_temp_aggregate(), which several loops may call concurrently.
+ */
+struct drive_temp_snapshot
+{
+    float temps[SMC_DRIVE_N];
+    float weights[SMC_DRIVE_N];
+};
+
+/**
+ * @brief Fill the snapshot and count the usable drives.
+ *
+ * @param powered set to the number of powered on drives, usable or not.
+ *
+ * @return number of drives with a usable reading.
+ */
+static uint16_t drive_temp_gather(const struct drive_temp_cfg* cfg,
+                                  struct drive_temp_snapshot* snap,
+                                  uint16_t* powered)
+{
+    uint16_t count = MIN(cfg->drive_count, SMC_DRIVE_N);
+    uint16_t valid = 0;
+    uint32_t now_ms = k_uptime_get_32();
+
+    *powered = 0;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        struct sensor_store_reading reading;
+        bool on = platform_get_hdd_power_state(i);
+        bool ok = on && (sensor_store_get(cfg->sensors[i], &reading) == 0) &&
+                  (reading.status == SENSOR_STORE_VALID) &&
+                  (now_ms - reading.timestamp_ms <= cfg->max_age_ms) &&
+                  (reading.value >= cfg->valid_min) &&
+                  (reading.value <= cfg->valid_max);
+
+        snap->temps[i] = ok ? reading.value : 0.0f;
+        snap->weights[i] = ok ? 1.0f : 0.0f;
+        valid += ok;
+        *powered += on;
+    }
+    return valid;
+}
+
+static float drive_temp_max(const struct drive_temp_snapshot* snap,
+                            uint16_t count)
+{
+    float max = -FLT_MAX;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        float value = (snap->weights[i] != 0.0f) ? snap->temps[i] : -FLT_MAX;
+        max = (value > max) ? value : max;
+    }
+    return max;
+}
+
+static float drive_temp_mean(const struct drive_temp_snapshot* snap,
+                             uint16_t count, uint16_t valid)
+{
+    float sum = 0.0f;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        sum += snap->temps[i] * snap->weights[i];
+    }
+    return sum / valid;
+}
+
+/**
+ * @brief Mean of the k hottest valid drives.
+ *
+ * Keeps the k hottest readings in a small descending array, so the cost is
+ * O(drives * k) with k bounded by DRIVE_TEMP_TOP_K_MAX.
+ */
+static float drive_temp_top_k_mean(const struct drive_temp_snapshot* snap,
+                                   uint16_t count, uint16_t valid, uint8_t k)
+{
+    float top[DRIVE_TEMP_TOP_K_MAX];
+    uint8_t used = 0;
+
+    k = CLAMP(k, 1, DRIVE_TEMP_TOP_K_MAX);
+    k = MIN(k, valid);
+
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        if (snap->weights[i] == 0.0f)
+        {
+            continue;
+        }
+
+        float value = snap->temps[i];
+        if (used == k && value <= top[k - 1])
+        {
+            continue;
+        }
+
+        uint8_t pos = (used < k) ? used++ : (k - 1);
+        while (pos > 0 && top[pos - 1] < value)
+        {
+            top[pos] = top[pos - 1];
+            pos--;
+        }
+        top[pos] = value;
+    }
+
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < used; ++i)
+    {
+        sum += top[i];
+    }
+    return sum / used;
+}
+
+float drive_temp_aggregate(const struct drive_temp_cfg* cfg)
+{
+    struct drive_temp_snapshot snap;
+    uint16_t count = MIN(cfg->drive_count, SMC_DRIVE_N);
+    uint16_t powered;
+    uint16_t valid = drive_temp_gather(cfg, &snap, &powered);
+
+    if (powered == 0)
+    {
+        return cfg->idle;
+    }
+    if (valid == 0)
+    {
+        return cfg->fallback;
+    }
+
+    switch (cfg->policy)
+    {
+        case DRIVE_TEMP_POLICY_MEAN:
+            return drive_temp_mean(&snap, count, valid);
+        case DRIVE_TEMP_POLICY_TOP_K_MEAN:
+            return drive_temp_top_k_mean(&snap, count, valid, cfg->top_k);
+        case DRIVE_TEMP_POLICY_MAX:
+        default:
+            return drive_temp_max(&snap, count);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRIVE_TEMP_H_
+#define DRIVE_TEMP_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Largest K supported by DRIVE_TEMP_POLICY_TOP_K_MEAN.
+ */
+#define DRIVE_TEMP_TOP_K_MAX 8
+
+/**
+ * @brief How the readings of all drives are reduced to one temperature.
+ */
+enum drive_temp_policy
+{
+    DRIVE_TEMP_POLICY_MAX = 0,
+    DRIVE_TEMP_POLICY_MEAN,
+    // Mean of the K hottest drives.
+    DRIVE_TEMP_POLICY_TOP_K_MEAN,
+};
+
+/**
+ * @brief Drive temperature aggregation configuration.
+ */
+struct drive_temp_cfg
+{
+    // Temperature sensor of each drive, indexed by smc_drive_id.
+    const uint32_t* sensors;
+    uint16_t drive_count;
+
+    enum drive_temp_policy policy;
+    uint8_t top_k;
+
+    // Readings outside [valid_min, valid_max] are treated as absent.
+    float valid_min;
+    float valid_max;
+
+    // Readings published more than max_age_ms ago are treated as absent, so
+    // a drive whose poller stopped does not hold the aggregate.
+    uint32_t max_age_ms;
+
+    // Returned when drives are powered on but none has a usable reading.
+    // Should be hot enough to drive the fans high, so losing every reading
+    // fails safe.
+    float fallback;
+
+    // Returned when every drive is powered off. There is nothing to cool, so
+    // this should let the loop settle at its minimum output.
+    float idle;
+};
+
+/**
+ * @brief Aggregate the temperature of all powered on drives.
+ *
+ * Drives that are powered off, fail to read, report an implausible value or
+ * have a stale reading are skipped. Safe to call from several threads.
+ *
+ * @param cfg aggregation configuration.
+ *
+ * @return aggregated temperature, cfg->idle if no drive is powered on, or
+ * cfg->fallback if no powered on drive is usable.
+ */
+float drive_temp_aggregate(const struct drive_temp_cfg* cfg);
+
+#endif /* DRIVE_TEMP_H_ */
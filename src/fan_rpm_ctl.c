@@ -0,0 +1,183 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fan_rpm_ctl.h"
+
+#include "platform_cfg.h"
+#include "sensor_store.h"
+
+#include <kernel.h>
+#include <logging/log.h>
+#include <smc/fan_sensor.h>
+#include <smc/pid.h>
+#include <smc/pid_sensor.h>
+#include <smc/utils.h>
+
+LOG_MODULE_REGISTER(fan_rpm_ctl, LOG_LEVEL_WRN);
+
+#define FAN_RPM_CTL_DT (CONFIG_SMC_FAN_RPM_CTL_PERIOD_MS / 1000.0f)
+
+// The tach holds its last RPM for up to the stall timeout. A reading older
+// than that plus two polls means the tach poller stopped.
+#define FAN_RPM_CTL_TACH_MAX_AGE_MS                                            \
+    (CONFIG_SMC_FAN_TACH_STALL_MS + (2 * CONFIG_SMC_FAN_TACH_PERIOD_MS))
+
+/**
+ * @brief Runtime state of the inner loop of a fan.
+ */
+struct fan_rpm_loop
+{
+    const struct fan_rpm_ctl_cfg* cfg;
+    float target_percent;
+    float integral;
+    // True while the loop is closed on the tach. Cleared on manual mode or
+    // tach loss so the next activation starts from the applied duty.
+    bool active;
+    // Set after a failed PWM update has been logged, to avoid flooding the
+    // log every step.
+    bool pwm_error;
+};
+
+static struct fan_rpm_loop fans[SMC_FAN_N];
+static size_t fan_count;
+
+static void fan_rpm_ctl_work_handler(struct k_work* work);
+K_WORK_DELAYABLE_DEFINE(fan_rpm_ctl_work, fan_rpm_ctl_work_handler);
+
+static void fan_rpm_apply(uint8_t fan, float duty)
+{
+    duty = CLAMP(duty, MIN_FAN_DUTY, MAX_FAN_DUTY);
+    writeSensor(fans[fan].cfg->duty_sensor, duty);
+    sensor_store_update(fans[fan].cfg->duty_sensor, duty);
+
+    int ret = fan_set_duty_by_id(fan, duty);
+    if (ret != 0 && !fans[fan].pwm_error)
+    {
+        LOG_WRN("Set fan %d duty failed: %d", fan, ret);
+    }
+    fans[fan].pwm_error = (ret != 0);
+}
+
+static bool fan_rpm_has_tach(const struct fan_rpm_loop* loop)
+{
+    return loop->cfg->tach_sensor != FAN_RPM_CTL_NO_TACH;
+}
+
+static void fan_rpm_step(uint8_t fan)
+{
+    struct fan_rpm_loop* loop = &fans[fan];
+    const struct fan_rpm_ctl_cfg* cfg = loop->cfg;
+
+    float open_loop = loop->target_percent;
+    float target_rpm = (open_loop / 100.0f) * cfg->max_rpm;
+    // A failed or stale tach reads 0 RPM and runs the fan open loop.
+    float rpm = sensor_store_value_or(cfg->tach_sensor,
+                                      FAN_RPM_CTL_TACH_MAX_AGE_MS, 0.0f);
+
+    if (rpm < cfg->min_rpm)
+    {
+        // No usable tach. Run open loop until it comes back.
+        if (loop->active)
+        {
+            LOG_WRN("Fan %d tach lost (%d RPM), running open loop", fan,
+                    (int)rpm);
+        }
+        loop->active = false;
+        fan_rpm_apply(fan, open_loop);
+        return;
+    }
+
+    float error = target_rpm - rpm;
+
+    if (!loop->active)
+    {
+        // Bumpless transfer: pick the trim that reproduces the duty currently
+        // applied, so closing the loop does not step the fan.
+        float applied = readSensor(cfg->duty_sensor);
+        loop->integral = applied - open_loop - (cfg->kP * error);
+        loop->active = true;
+    }
+
+    loop->integral += cfg->kI * error * FAN_RPM_CTL_DT;
+    loop->integral = CLAMP(loop->integral, -cfg->trim_limit, cfg->trim_limit);
+
+    float trim = CLAMP((cfg->kP * error) + loop->integral, -cfg->trim_limit,
+                       cfg->trim_limit);
+    fan_rpm_apply(fan, open_loop + trim);
+}
+
+static void fan_rpm_ctl_work_handler(struct k_work* work)
+{
+    ARG_UNUSED(work);
+
+    int mode = thermalControlConfig();
+    bool automatic = (mode != KTHERMAL_CONTROLS_NOT_CONFIGURED) &&
+                     (mode != KTHERMAL_CONTROLS_MANUAL);
+
+    for (uint8_t fan = 0; fan < fan_count; ++fan)
+    {
+        if (!automatic)
+        {
+            // The host owns the duty. Resume from it once back in automatic.
+            fans[fan].active = false;
+        }
+        else if (fan_rpm_has_tach(&fans[fan]))
+        {
+            fan_rpm_step(fan);
+        }
+    }
+
+    k_work_schedule(&fan_rpm_ctl_work,
+                    K_MSEC(CONFIG_SMC_FAN_RPM_CTL_PERIOD_MS));
+}
+
+int fan_rpm_ctl_init(const struct fan_rpm_ctl_cfg* cfg, size_t count)
+{
+    IS_PARAM_NULL(cfg, "cfg cannot be NULL");
+
+    if (count > SMC_FAN_N)
+    {
+        LOG_ERR("Invalid fan count: %zu", count);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        fans[i].cfg = &cfg[i];
+        fans[i].target_percent = readSensor(cfg[i].duty_sensor);
+        fans[i].active = false;
+    }
+    fan_count = count;
+
+    k_work_schedule(&fan_rpm_ctl_work,
+                    K_MSEC(CONFIG_SMC_FAN_RPM_CTL_PERIOD_MS));
+    return 0;
+}
+
+int fan_rpm_ctl_set_target(uint8_t fan, float percent)
+{
+    if (fan >= fan_count)
+    {
+        return -1;
+    }
+
+    fans[fan].target_percent = percent;
+    if (!fan_rpm_has_tach(&fans[fan]))
+    {
+        fan_rpm_apply(fan, percent);
+    }
+    return 0;
+}
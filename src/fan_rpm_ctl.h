@@ -0,0 +1,78 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FAN_RPM_CTL_H_
+#define FAN_RPM_CTL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief tach_sensor value for a fan without tach. Such a fan runs open loop.
+ */
+#define FAN_RPM_CTL_NO_TACH UINT32_MAX
+
+/**
+ * @brief Inner RPM loop configuration of a fan.
+ *
+ * The thermal arbiter requests a percentage of max_rpm. The inner loop drives
+ * the PWM duty so the tach follows that target. The duty is the open loop
+ * estimate (target / max_rpm) plus a PI trim bounded to +/- trim_limit.
+ */
+struct fan_rpm_ctl_cfg
+{
+    // Sensor id of the PWM duty and of the tach of this fan.
+    uint32_t duty_sensor;
+    uint32_t tach_sensor;
+
+    // RPM at 100% duty. Used to convert the thermal request into a target.
+    float max_rpm;
+    // Below this RPM the tach is considered stalled or missing and the fan
+    // falls back to open loop.
+    float min_rpm;
+
+    // Gains in duty percent per RPM of error (kI per second).
+    float kP;
+    float kI;
+    // Largest correction, in duty percent, the loop may add to the open loop
+    // estimate.
+    float trim_limit;
+};
+
+/**
+ * @brief Start the inner RPM loops.
+ *
+ * @param cfg per fan configuration, indexed by fan id.
+ * @param count number of fans.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int fan_rpm_ctl_init(const struct fan_rpm_ctl_cfg* cfg, size_t count);
+
+/**
+ * @brief Set the airflow request of a fan.
+ *
+ * Fans without tach are driven immediately, the others track the matching
+ * RPM target from the next inner loop step.
+ *
+ * @param fan fan id.
+ * @param percent requested airflow, in percent of the fan max RPM.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int fan_rpm_ctl_set_target(uint8_t fan, float percent);
+
+#endif /* FAN_RPM_CTL_H_ */
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fan_tach.h"
+
+#include "platform_cfg.h"
+#include "poll_sched.h"
+#include "sensor_filter.h"
+#include "sensor_store.h"
+
+#include <device.h>
+#include <drivers/pwm.h>
+#include <kernel.h>
+#include <logging/log.h>
+#include <smc/sensor.h>
+#include <smc/utils.h>
+
+LOG_MODULE_REGISTER(fan_tach, LOG_LEVEL_WRN);
+
+#define FAN_TACH_SAMPLES CONFIG_SMC_FAN_TACH_SAMPLES
+
+/**
+ * @brief Capture state of one fan.
+ *
+ * periods and count are written by the capture callback only while capture
+ * is enabled, and read by the poller only after disabling it.
+ */
+struct fan_tach
+{
+    const struct fan_tach_cfg* cfg;
+    const struct device* dev;
+    uint64_t cycles_per_sec;
+
+    uint32_t periods[FAN_TACH_SAMPLES];
+    volatile uint8_t count;
+
+    // Uptime of the last poll that found a complete tach period.
+    uint32_t last_period_ms;
+};
+
+static struct fan_tach tachs[SMC_FAN_N];
+static uint32_t tach_sensors[SMC_FAN_N];
+static size_t tach_count;
+
+static void fan_tach_capture(const struct device* dev, uint32_t channel,
+                             uint32_t period_cycles, uint32_t pulse_cycles,
+                             int status, void* user_data)
+{
+    ARG_UNUSED(pulse_cycles);
+    struct fan_tach* tach = user_data;
+
+    if (status != 0 || period_cycles == 0 || tach->count >= FAN_TACH_SAMPLES)
+    {
+        return;
+    }
+
+    tach->periods[tach->count++] = period_cycles;
+    if (tach->count == FAN_TACH_SAMPLES)
+    {
+        // Enough for this poll, stay quiet until the next one.
+        pwm_pin_disable_capture(dev, channel);
+    }
+}
+
+static uint32_t fan_tach_median(uint32_t* periods, uint8_t count)
+{
+    for (uint8_t i = 1; i < count; ++i)
+    {
+        uint32_t period = periods[i];
+        uint8_t j = i;
+        while (j > 0 && periods[j - 1] > period)
+        {
+            periods[j] = periods[j - 1];
+            j--;
+        }
+        periods[j] = period;
+    }
+    return periods[count / 2];
+}
+
+static void fan_tach_poll_one(struct fan_tach* tach)
+{
+    const struct fan_tach_cfg* cfg = tach->cfg;
+    uint32_t now_ms = k_uptime_get_32();
+
+    if (tach->count == 0 &&
+        now_ms - tach->last_period_ms < CONFIG_SMC_FAN_TACH_STALL_MS)
+    {
+        // A slow fan can take longer than a poll to complete a period. Leave
+        // the capture running so the period can complete, and keep the last
+        // reading until the fan is considered stalled.
+        return;
+    }
+
+    pwm_pin_disable_capture(tach->dev, cfg->channel);
+
+    float rpm = 0.0f;
+    uint8_t count = tach->count;
+    if (count != 0)
+    {
+        uint32_t period = fan_tach_median(tach->periods, count);
+        rpm = (60.0f * tach->cycles_per_sec) /
+              ((float)period * cfg->pulses_per_rev);
+        tach->last_period_ms = now_ms;
+    }
+
+    rpm = sensor_filter_apply(cfg->sensor_id, rpm);
+    set_sensor_reading_float(cfg->sensor_id, rpm);
+    sensor_store_update(cfg->sensor_id, rpm);
+
+    tach->count = 0;
+    int ret = pwm_pin_enable_capture(tach->dev, cfg->channel);
+    if (ret != 0)
+    {
+        LOG_WRN("Rearm %s capture failed: %d", cfg->name, ret);
+        sensor_filter_reset(cfg->sensor_id);
+        sensor_store_fail(cfg->sensor_id);
+    }
+}
+
+static void fan_tach_poll(const uint32_t* sensors, size_t count, void* ctx)
+{
+    ARG_UNUSED(sensors);
+    ARG_UNUSED(count);
+    ARG_UNUSED(ctx);
+
+    for (size_t i = 0; i < tach_count; ++i)
+    {
+        fan_tach_poll_one(&tachs[i]);
+    }
+}
+
+static int fan_tach_add(struct fan_tach* tach, const struct fan_tach_cfg* cfg)
+{
+    tach->cfg = cfg;
+    tach->dev = device_get_binding(cfg->dev_label);
+    if (tach->dev == NULL)
+    {
+        LOG_ERR("Tach device %s not found", cfg->dev_label);
+        return -ENODEV;
+    }
+
+    RETURN_IF_IERROR(pwm_get_cycles_per_sec(tach->dev, cfg->channel,
+                                            &tach->cycles_per_sec));
+    RETURN_IF_IERROR(pwm_pin_configure_capture(
+        tach->dev, cfg->channel,
+        PWM_CAPTURE_TYPE_PERIOD | PWM_CAPTURE_MODE_CONTINUOUS,
+        fan_tach_capture, tach));
+
+    RETURN_IF_IERROR(sensor_register_by_id(
+        cfg->sensor_id, tach->dev, cfg->name, cfg->max_rpm, /*min=*/0,
+        /*poll_rate_ms=*/0, /*write_protect=*/true, rpm,
+        /*gain=*/1, /*offset=*/0));
+
+    tach->last_period_ms = k_uptime_get_32();
+    return pwm_pin_enable_capture(tach->dev, cfg->channel);
+}
+
+int fan_tach_init(const struct fan_tach_cfg* cfg, size_t count)
+{
+    IS_PARAM_NULL(cfg, "cfg cannot be NULL");
+
+    if (count > SMC_FAN_N)
+    {
+        LOG_ERR("Invalid tach count: %zu", count);
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        RETURN_IF_IERROR(fan_tach_add(&tachs[i], &cfg[i]));
+        tach_sensors[i] = cfg[i].sensor_id;
+    }
+    tach_count = count;
+
+    return poll_sched_add(tach_sensors, tach_count,
+                          CONFIG_SMC_FAN_TACH_PERIOD_MS, fan_tach_poll, NULL);
+}
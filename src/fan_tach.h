@@ -0,0 +1,57 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FAN_TACH_H_
+#define FAN_TACH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Tach input of one fan.
+ */
+struct fan_tach_cfg
+{
+    // PWM device capturing the tach signal, and its capture channel.
+    const char* dev_label;
+    uint32_t channel;
+
+    uint32_t sensor_id;
+    const char* name;
+    uint8_t pulses_per_rev;
+    float max_rpm;
+};
+
+/**
+ * @brief Start measuring the RPM of every fan in cfg.
+ *
+ * Each tach sensor is registered and polled from the poll scheduler every
+ * CONFIG_SMC_FAN_TACH_PERIOD_MS. Between two polls the capture unit records
+ * up to CONFIG_SMC_FAN_TACH_SAMPLES tach periods, then is disabled so a fast
+ * fan does not keep interrupting. The RPM is computed from the median
+ * period, which rejects glitches on the tach line. A poll without a complete
+ * period keeps the last reading and leaves the capture running, so a slow fan
+ * is measured over several polls. A fan without a complete period for
+ * CONFIG_SMC_FAN_TACH_STALL_MS reads 0 RPM.
+ *
+ * @param cfg tach list. Must stay valid while monitored.
+ * @param count number of fans.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int fan_tach_init(const struct fan_tach_cfg* cfg, size_t count);
+
+#endif /* FAN_TACH_H_ */
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fan_zone.h"
+
+#include <errno.h>
+#include <logging/log.h>
+#include <stdbool.h>
+
+LOG_MODULE_REGISTER(fan_zone, LOG_LEVEL_WRN);
+
+int fan_zone_validate(const struct fan_zone* zones, size_t zone_count)
+{
+    for (size_t z = 0; z < zone_count; ++z)
+    {
+        const struct fan_zone* zone = &zones[z];
+        if (zone->policy != FAN_ZONE_POLICY_WEIGHTED)
+        {
+            continue;
+        }
+
+        if (zone->weights == NULL)
+        {
+            LOG_ERR("Zone %s is weighted but has no weights", zone->name);
+            return -EINVAL;
+        }
+
+        float weight_sum = 0.0f;
+        for (uint8_t i = 0; i < zone->loop_count; ++i)
+        {
+            if (zone->weights[i] < 0.0f)
+            {
+                LOG_ERR("Zone %s has a negative weight", zone->name);
+                return -EINVAL;
+            }
+            weight_sum += zone->weights[i];
+        }
+
+        if (weight_sum <= 0.0f)
+        {
+            LOG_ERR("Zone %s weights sum to zero", zone->name);
+            return -EINVAL;
+        }
+    }
+    return 0;
+}
+
+static float fan_zone_request(const struct fan_zone* zone,
+                              const float* requests, uint32_t enabled_mask,
+                              float floor)
+{
+    float result = floor;
+    float weighted = 0.0f;
+    float weight_sum = 0.0f;
+
+    for (uint8_t i = 0; i < zone->loop_count; ++i)
+    {
+        uint8_t loop = zone->loops[i];
+        if ((enabled_mask & (1U << loop)) == 0)
+        {
+            continue;
+        }
+
+        switch (zone->policy)
+        {
+            case FAN_ZONE_POLICY_PRIORITY:
+                return requests[loop];
+            case FAN_ZONE_POLICY_WEIGHTED:
+                weighted += zone->weights[i] * requests[loop];
+                weight_sum += zone->weights[i];
+                break;
+            case FAN_ZONE_POLICY_MAX:
+            default:
+                if (requests[loop] > result)
+                {
+                    result = requests[loop];
+                }
+                break;
+        }
+    }
+
+    if (zone->policy == FAN_ZONE_POLICY_WEIGHTED && weight_sum > 0.0f)
+    {
+        result = weighted / weight_sum;
+    }
+    return result;
+}
+
+void fan_zone_arbitrate(const struct fan_zone* zones, size_t zone_count,
+                        const float* requests, uint32_t enabled_mask,
+                        float floor, float* fan_duty, size_t fan_count)
+{
+    for (size_t fan = 0; fan < fan_count; ++fan)
+    {
+        fan_duty[fan] = floor;
+    }
+
+    for (size_t z = 0; z < zone_count; ++z)
+    {
+        const struct fan_zone* zone = &zones[z];
+        float duty = fan_zone_request(zone, requests, enabled_mask, floor);
+
+        for (uint8_t i = 0; i < zone->fan_count; ++i)
+        {
+            uint8_t fan = zone->fans[i];
+            if (fan < fan_count && duty > fan_duty[fan])
+            {
+                fan_duty[fan] = duty;
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FAN_ZONE_H_
+#define FAN_ZONE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief How a zone combines the requests of its loops into one duty.
+ */
+enum fan_zone_policy
+{
+    // Highest request of the enabled loops.
+    FAN_ZONE_POLICY_MAX = 0,
+    // Weighted mean of the enabled loops, using fan_zone.weights.
+    FAN_ZONE_POLICY_WEIGHTED,
+    // Request of the first enabled loop in fan_zone.loops.
+    FAN_ZONE_POLICY_PRIORITY,
+};
+
+/**
+ * @brief An airflow zone: a set of loops driving a set of fans.
+ */
+struct fan_zone
+{
+    const char* name;
+    enum fan_zone_policy policy;
+
+    // Indexes into the request table. For FAN_ZONE_POLICY_PRIORITY the first
+    // entry has the highest priority.
+    const uint8_t* loops;
+    // One weight per entry of loops. Only used by FAN_ZONE_POLICY_WEIGHTED.
+    const float* weights;
+    uint8_t loop_count;
+
+    // Fan indexes driven by this zone.
+    const uint8_t* fans;
+    uint8_t fan_count;
+};
+
+/**
+ * @brief Check a zone table before it is used.
+ *
+ * A FAN_ZONE_POLICY_WEIGHTED zone must have one non negative weight per
+ * loop, with a sum above zero.
+ *
+ * @param zones zone table.
+ * @param zone_count number of zones.
+ *
+ * @return 0 on success, -EINVAL if a zone is malformed.
+ */
+int fan_zone_validate(const struct fan_zone* zones, size_t zone_count);
+
+/**
+ * @brief Arbitrate all zones into a per fan duty.
+ *
+ * The zone table must have passed fan_zone_validate().
+ *
+ * A fan shared by several zones gets the highest of their requests. Fans not
+ * part of any zone are left at floor.
+ *
+ * @param zones zone table.
+ * @param zone_count number of zones.
+ * @param requests loop requests, indexed by fan_zone.loops.
+ * @param enabled_mask bit n set if request n is valid.
+ * @param floor lowest duty handed to a fan.
+ * @param fan_duty output, one entry per fan.
+ * @param fan_count number of entries in fan_duty.
+ */
+void fan_zone_arbitrate(const struct fan_zone* zones, size_t zone_count,
+                        const float* requests, uint32_t enabled_mask,
+                        float floor, float* fan_duty, size_t fan_count);
+
+#endif /* FAN_ZONE_H_ */
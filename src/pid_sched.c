@@ -0,0 +1,725 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pid_sched.h"
+
+#include "platform_cfg.h"
+
+#include <kernel.h>
+#include <logging/log.h>
+#include <math.h>
+#include <shell/shell.h>
+#include <smc/utils.h>
+#include <string.h>
+#include <sys/crc.h>
+
+#ifdef CONFIG_BOARD_NATIVE_POSIX_64BIT
+#include <native_rtc.h>
+#endif
+
+LOG_MODULE_REGISTER(pid_sched, LOG_LEVEL_WRN);
+
+#define PID_SCHED_MAX_LOOPS SMC_CLOSED_LOOP_PID_CNT
+
+/**
+ * @brief Runtime state of a single loop.
+ */
+struct pid_sched_loop
+{
+    pid_desc_t* desc;
+    const struct pid_sched_cfg* cfg;
+    uint64_t period_us;
+    uint64_t due_us;
+    uint64_t last_run_us;
+
+    float integral;
+    float prev_input;
+    float output;
+    bool primed;
+
+    struct pid_sched_stats stats;
+
+    // Parameters staged by pid_sched_stage_params(). shadow_seq is odd while
+    // a writer is updating shadow.
+    struct pid_sched_params shadow;
+    atomic_t shadow_seq;
+    atomic_val_t applied_seq;
+};
+
+static struct pid_sched_loop loops[PID_SCHED_MAX_LOOPS];
+static const struct pid_sched_cfg* loop_cfg;
+static size_t loop_count;
+static pid_sched_output_t output_cb;
+
+_Static_assert(PID_SCHED_MAX_LOOPS <= 32, "loop masks are 32 bit");
+
+/**
+ * @brief Event trigger state.
+ *
+ * sensor_loops holds, per sensor, a mask of the loops listing it in their
+ * event_sensors. event_ref holds, per sensor, the value at the last trigger.
+ * Loops with a pending trigger have their bit set in event_pending.
+ */
+static uint32_t sensor_loops[SMC_SENSOR_N];
+static float event_ref[SMC_SENSOR_N];
+static bool event_ref_valid[SMC_SENSOR_N];
+static struct k_spinlock event_lock;
+static atomic_t event_pending;
+
+/**
+ * @brief Min-heap of loop indexes keyed on due_us.
+ */
+static uint8_t heap[PID_SCHED_MAX_LOOPS];
+
+/**
+ * @brief Loop state kept across watchdog resets.
+ *
+ * Lives in a no-init section so it is not cleared on boot. The CRC covers
+ * everything before it.
+ */
+struct pid_sched_retained
+{
+    uint32_t magic;
+    uint32_t count;
+    struct
+    {
+        float integral;
+        float output;
+    } loops[PID_SCHED_MAX_LOOPS];
+    uint32_t crc;
+};
+
+// Bump the low byte when the layout of pid_sched_retained changes.
+#define PID_SCHED_RETAINED_MAGIC 0x50494401
+
+static __noinit struct pid_sched_retained retained;
+
+static struct k_spinlock stats_lock;
+
+// Serializes writers of the shadow parameters. Never taken by the scheduler.
+K_MUTEX_DEFINE(params_lock);
+
+K_THREAD_STACK_DEFINE(pid_sched_stack, CONFIG_SMC_PID_SCHED_STACK_SIZE);
+static struct k_thread pid_sched_thread;
+K_SEM_DEFINE(pid_sched_wake, 0, 1);
+
+static uint64_t now_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+/**
+ * @brief Measure the CPU cost of a step.
+ *
+ * step_begin() returns an opaque timestamp for step_end_ns().
+ */
+#ifdef CONFIG_BOARD_NATIVE_POSIX_64BIT
+// Virtual time does not advance while code runs, use the host clock.
+static uint64_t step_begin(void)
+{
+    return native_rtc_gettime_us(RTC_CLOCK_REAL);
+}
+
+static uint32_t step_end_ns(uint64_t begin)
+{
+    return (uint32_t)((native_rtc_gettime_us(RTC_CLOCK_REAL) - begin) * 1000);
+}
+#else
+static uint64_t step_begin(void)
+{
+    return k_cycle_get_32();
+}
+
+static uint32_t step_end_ns(uint64_t begin)
+{
+    // Subtract in 32 bit so a wrap of the cycle counter is harmless.
+    uint32_t cycles = k_cycle_get_32() - (uint32_t)begin;
+    return (uint32_t)k_cyc_to_ns_floor64(cycles);
+}
+#endif
+
+static void heap_swap(size_t a, size_t b)
+{
+    uint8_t tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+}
+
+static bool heap_before(size_t a, size_t b)
+{
+    return loops[heap[a]].due_us < loops[heap[b]].due_us;
+}
+
+/**
+ * @brief Restore the heap property after the root deadline moved later.
+ */
+static void heap_sift_down(size_t pos)
+{
+    for (;;)
+    {
+        size_t left = (2 * pos) + 1;
+        size_t right = left + 1;
+        size_t min = pos;
+
+        if (left < loop_count && heap_before(left, min))
+        {
+            min = left;
+        }
+        if (right < loop_count && heap_before(right, min))
+        {
+            min = right;
+        }
+        if (min == pos)
+        {
+            return;
+        }
+        heap_swap(pos, min);
+        pos = min;
+    }
+}
+
+static void heap_build(void)
+{
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+        heap[i] = (uint8_t)i;
+    }
+    for (size_t i = loop_count / 2; i-- > 0;)
+    {
+        heap_sift_down(i);
+    }
+}
+
+/**
+ * @brief Evaluate one PID step.
+ *
+ * Gains and slew limits keep the smc-common meaning of "per tick", a tick
+ * being the descriptor's ts. dt is converted to ticks, so a loop scheduled
+ * faster than its ts takes proportionally smaller steps and keeps its
+ * tuning. The integral term is clamped to i_lim and carries the absolute
+ * output, matching the descriptor limits used by smc-common.
+ */
+static float pid_sched_step(struct pid_sched_loop* loop, float dt)
+{
+    const pid_desc_t* desc = loop->desc;
+    const pid_info_t* info = &desc->info;
+    float ticks = dt / ((info->ts > 0) ? (float)info->ts : 1.0f);
+
+    float setpoint = desc->setpt.hdlr.get(desc->setpt.ctx);
+    float input = loop->cfg->input.hdlr.get(loop->cfg->input.ctx);
+    float error = setpoint - input;
+
+    if (fabsf(error) < info->deadband)
+    {
+        error = 0.0f;
+    }
+
+    if (!loop->primed)
+    {
+        loop->prev_input = input;
+        loop->primed = true;
+    }
+
+    loop->integral += info->kI * error * ticks;
+    loop->integral = CLAMP(loop->integral, info->i_lim.min, info->i_lim.max);
+
+    // Derivative on measurement to avoid kicks on setpoint changes. Skipped
+    // when unused so a tiny dt cannot turn 0 * inf into NaN.
+    float derivative = 0.0f;
+    if (info->kD != 0.0f)
+    {
+        derivative = -(input - loop->prev_input) / ticks;
+    }
+    loop->prev_input = input;
+
+    float out = (info->kP * error) + loop->integral + (info->kD * derivative);
+
+    if (info->slew_pos > 0.0f &&
+        (out - loop->output) > info->slew_pos * ticks)
+    {
+        out = loop->output + (info->slew_pos * ticks);
+    }
+    if (info->slew_neg > 0.0f &&
+        (loop->output - out) > info->slew_neg * ticks)
+    {
+        out = loop->output - (info->slew_neg * ticks);
+    }
+
+    return CLAMP(out, info->out_lim.min, info->out_lim.max);
+}
+
+static void pid_sched_record(struct pid_sched_loop* loop, uint64_t start)
+{
+    uint32_t jitter = (uint32_t)(start - loop->due_us);
+    uint32_t period =
+        (loop->last_run_us != 0) ? (uint32_t)(start - loop->last_run_us) : 0;
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    loop->stats.runs++;
+    loop->stats.period_us = period;
+    loop->stats.last_jitter_us = jitter;
+    loop->stats.max_jitter_us = MAX(loop->stats.max_jitter_us, jitter);
+    loop->stats.total_jitter_us += jitter;
+    k_spin_unlock(&stats_lock, key);
+
+    loop->last_run_us = start;
+}
+
+/**
+ * @brief Apply staged parameters, if any, to the descriptor of a loop.
+ *
+ * Runs on the scheduler thread at a cycle boundary. Never blocks: a copy that
+ * overlaps a write is dropped and retried on the next step.
+ */
+static void pid_sched_apply_params(struct pid_sched_loop* loop)
+{
+    atomic_val_t seq = atomic_get(&loop->shadow_seq);
+    if ((seq == loop->applied_seq) || (seq & 1))
+    {
+        return;
+    }
+
+    struct pid_sched_params params = loop->shadow;
+    compiler_barrier();
+    if (atomic_get(&loop->shadow_seq) != seq)
+    {
+        return;
+    }
+
+    loop->desc->localSetpoint = params.setpoint;
+    loop->desc->info.kP = params.kP;
+    loop->desc->info.kI = params.kI;
+    loop->desc->info.kD = params.kD;
+    loop->applied_seq = seq;
+}
+
+static bool pid_sched_param_ok(const char* name, float value, float min,
+                               float max)
+{
+    if (isfinite(value) && value >= min && value <= max)
+    {
+        return true;
+    }
+    LOG_ERR("PID %s %f outside [%f, %f]", name, (double)value, (double)min,
+            (double)max);
+    return false;
+}
+
+int pid_sched_stage_params(uint32_t index,
+                           const struct pid_sched_params* params)
+{
+    IS_PARAM_NULL(params, "params cannot be NULL");
+
+    if (index >= loop_count)
+    {
+        return -1;
+    }
+
+    struct pid_sched_loop* loop = &loops[index];
+    const struct pid_sched_params* min = &loop->cfg->params_min;
+    const struct pid_sched_params* max = &loop->cfg->params_max;
+
+    if (!pid_sched_param_ok("setpoint", params->setpoint, min->setpoint,
+                            max->setpoint) ||
+        !pid_sched_param_ok("kP", params->kP, min->kP, max->kP) ||
+        !pid_sched_param_ok("kI", params->kI, min->kI, max->kI) ||
+        !pid_sched_param_ok("kD", params->kD, min->kD, max->kD))
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&params_lock, K_FOREVER);
+    atomic_inc(&loop->shadow_seq);
+    compiler_barrier();
+    loop->shadow = *params;
+    compiler_barrier();
+    atomic_inc(&loop->shadow_seq);
+    k_mutex_unlock(&params_lock);
+
+    return 0;
+}
+
+int pid_sched_get_params(uint32_t index, struct pid_sched_params* params)
+{
+    IS_PARAM_NULL(params, "params cannot be NULL");
+
+    if (index >= loop_count)
+    {
+        return -1;
+    }
+
+    const struct pid_sched_loop* loop = &loops[index];
+
+    k_mutex_lock(&params_lock, K_FOREVER);
+    if (atomic_get(&loop->shadow_seq) != loop->applied_seq)
+    {
+        // Staged, not applied yet.
+        *params = loop->shadow;
+    }
+    else
+    {
+        params->setpoint = loop->desc->localSetpoint;
+        params->kP = loop->desc->info.kP;
+        params->kI = loop->desc->info.kI;
+        params->kD = loop->desc->info.kD;
+    }
+    k_mutex_unlock(&params_lock);
+
+    return 0;
+}
+
+static void pid_sched_record_step(struct pid_sched_loop* loop, uint32_t ns)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    loop->stats.steps++;
+    loop->stats.max_step_ns = MAX(loop->stats.max_step_ns, ns);
+    loop->stats.total_step_ns += ns;
+    loop->stats.input = loop->prev_input;
+    loop->stats.output = loop->output;
+    loop->stats.output_at_min = loop->output <= loop->desc->info.out_lim.min;
+    k_spin_unlock(&stats_lock, key);
+}
+
+static uint32_t pid_sched_retained_crc(void)
+{
+    return crc32_ieee((const uint8_t*)&retained,
+                      offsetof(struct pid_sched_retained, crc));
+}
+
+/**
+ * @brief Copy the state of a loop to the retained block.
+ *
+ * The CRC is only recomputed when the state changed, which is rare once a
+ * loop has settled or saturated.
+ */
+static void pid_sched_retain(uint32_t index)
+{
+    if ((retained.loops[index].integral == loops[index].integral) &&
+        (retained.loops[index].output == loops[index].output))
+    {
+        return;
+    }
+
+    retained.loops[index].integral = loops[index].integral;
+    retained.loops[index].output = loops[index].output;
+    retained.crc = pid_sched_retained_crc();
+}
+
+bool pid_sched_can_resume(size_t count)
+{
+    return (retained.magic == PID_SCHED_RETAINED_MAGIC) &&
+           (retained.count == count) &&
+           (retained.crc == pid_sched_retained_crc());
+}
+
+void pid_sched_notify(uint32_t sensor_id, float value)
+{
+    if (sensor_id >= SMC_SENSOR_N || loop_cfg == NULL)
+    {
+        return;
+    }
+
+    uint32_t dependent = sensor_loops[sensor_id];
+    if (dependent == 0)
+    {
+        return;
+    }
+
+    uint32_t triggered = 0;
+    k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+    if (!event_ref_valid[sensor_id])
+    {
+        event_ref[sensor_id] = value;
+        event_ref_valid[sensor_id] = true;
+    }
+
+    float moved = fabsf(value - event_ref[sensor_id]);
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+        if ((dependent & BIT(i)) && (moved >= loop_cfg[i].event_delta))
+        {
+            triggered |= BIT(i);
+        }
+    }
+    if (triggered != 0)
+    {
+        event_ref[sensor_id] = value;
+    }
+    k_spin_unlock(&event_lock, key);
+
+    if (triggered != 0)
+    {
+        atomic_or(&event_pending, triggered);
+        k_sem_give(&pid_sched_wake);
+    }
+}
+
+/**
+ * @brief Make the loops with a pending trigger due now.
+ */
+static void pid_sched_take_events(uint64_t now)
+{
+    uint32_t pending = atomic_clear(&event_pending);
+    if (pending == 0)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+        if (pending & BIT(i))
+        {
+            loops[i].due_us = MIN(loops[i].due_us, now);
+        }
+    }
+    heap_build();
+}
+
+static void pid_sched_run(void* p1, void* p2, void* p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (;;)
+    {
+        pid_sched_take_events(now_us());
+
+        struct pid_sched_loop* loop = &loops[heap[0]];
+        uint64_t now = now_us();
+
+        if (loop->due_us > now)
+        {
+            // Sleep until the earliest deadline.
+            k_sem_take(&pid_sched_wake, K_USEC(loop->due_us - now));
+            continue;
+        }
+
+        uint32_t index = heap[0];
+        uint64_t previous = loop->last_run_us;
+
+        if ((previous != 0) && (now - previous < k_ticks_to_us_ceil64(1)))
+        {
+            // A second trigger within one kernel tick of the last step, for
+            // example two drives of one poll batch. dt would be 0: fold it
+            // into the step that just ran.
+            loop->due_us = previous + loop->period_us;
+            heap_sift_down(0);
+            continue;
+        }
+
+        pid_sched_record(loop, now);
+
+        pid_sched_apply_params(loop);
+
+        if (loop->desc->info.enabled)
+        {
+            float dt = (previous != 0) ? (float)(now - previous) / 1e6f
+                                       : (float)loop->period_us / 1e6f;
+            uint64_t begin = step_begin();
+            loop->output = pid_sched_step(loop, dt);
+            pid_sched_record_step(loop, step_end_ns(begin));
+            pid_sched_retain(index);
+            output_cb(index, loop->output);
+        }
+
+        // Keep the nominal cadence. If a deadline was missed entirely, skip
+        // ahead instead of running a burst of catch-up steps.
+        loop->due_us += loop->period_us;
+        if (loop->due_us <= now)
+        {
+            loop->due_us = now + loop->period_us;
+        }
+        heap_sift_down(0);
+    }
+}
+
+int pid_sched_start(pid_desc_t* desc, const struct pid_sched_cfg* cfg,
+                    size_t count, pid_sched_output_t output, bool resume)
+{
+    IS_PARAM_NULL(desc, "desc cannot be NULL");
+    IS_PARAM_NULL(cfg, "cfg cannot be NULL");
+    IS_PARAM_NULL(output, "output cannot be NULL");
+
+    if (count == 0 || count > PID_SCHED_MAX_LOOPS)
+    {
+        LOG_ERR("Invalid PID loop count: %zu", count);
+        return -1;
+    }
+
+    if (resume && !pid_sched_can_resume(count))
+    {
+        LOG_WRN("No valid retained PID state, starting cold");
+        resume = false;
+    }
+
+    uint64_t now = now_us();
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t period_ms = cfg[i].period_ms;
+        if (period_ms == 0)
+        {
+            period_ms = (uint64_t)desc[i].info.ts * 1000;
+        }
+        if (period_ms == 0)
+        {
+            LOG_ERR("PID loop %zu has no period", i);
+            return -1;
+        }
+        if (cfg[i].input.hdlr.get == NULL)
+        {
+            LOG_ERR("PID loop %zu has no input", i);
+            return -1;
+        }
+
+        loops[i].desc = &desc[i];
+        loops[i].cfg = &cfg[i];
+        loops[i].period_us = period_ms * 1000;
+        loops[i].due_us = now + loops[i].period_us;
+        loops[i].output = desc[i].info.out_lim.min;
+        loops[i].stats.period_us = (uint32_t)loops[i].period_us;
+
+        if (cfg[i].event_delta > 0.0f)
+        {
+            for (size_t s = 0; s < cfg[i].event_sensor_count; ++s)
+            {
+                uint32_t sensor_id = cfg[i].event_sensors[s];
+                if (sensor_id >= SMC_SENSOR_N)
+                {
+                    LOG_ERR("PID loop %zu: invalid event sensor %u", i,
+                            sensor_id);
+                    return -1;
+                }
+                sensor_loops[sensor_id] |= BIT(i);
+            }
+        }
+
+        loops[i].shadow.setpoint = desc[i].localSetpoint;
+        loops[i].shadow.kP = desc[i].info.kP;
+        loops[i].shadow.kI = desc[i].info.kI;
+        loops[i].shadow.kD = desc[i].info.kD;
+        atomic_set(&loops[i].shadow_seq, 0);
+        loops[i].applied_seq = 0;
+    }
+    loop_count = count;
+    output_cb = output;
+    heap_build();
+    loop_cfg = cfg;
+
+    if (resume)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            loops[i].integral = retained.loops[i].integral;
+            loops[i].output = retained.loops[i].output;
+            output_cb(i, loops[i].output);
+        }
+        LOG_INF("Resumed PID state after watchdog reset");
+    }
+    else
+    {
+        memset(&retained, 0, sizeof(retained));
+        retained.magic = PID_SCHED_RETAINED_MAGIC;
+        retained.count = count;
+        for (size_t i = 0; i < count; ++i)
+        {
+            retained.loops[i].integral = loops[i].integral;
+            retained.loops[i].output = loops[i].output;
+        }
+        retained.crc = pid_sched_retained_crc();
+    }
+
+    k_tid_t tid = k_thread_create(
+        &pid_sched_thread, pid_sched_stack,
+        K_THREAD_STACK_SIZEOF(pid_sched_stack), pid_sched_run, NULL, NULL,
+        NULL, CONFIG_SMC_PID_SCHED_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "pid_sched");
+
+    return 0;
+}
+
+int pid_sched_get_stats(uint32_t index, struct pid_sched_stats* stats)
+{
+    IS_PARAM_NULL(stats, "stats cannot be NULL");
+
+    if (index >= loop_count)
+    {
+        return -1;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    *stats = loops[index].stats;
+    k_spin_unlock(&stats_lock, key);
+    return 0;
+}
+
+static int cmd_pid_sched_stats(const struct shell* shell, size_t argc,
+                               char** argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(shell, "%-8s %10s %8s %12s %12s %12s %12s", "loop",
+                "period_ms", "runs", "last_jit_us", "max_jit_us", "avg_jit_us",
+                "avg_step_ns");
+    for (uint32_t i = 0; i < loop_count; ++i)
+    {
+        struct pid_sched_stats stats;
+        pid_sched_get_stats(i, &stats);
+
+        uint32_t avg = (stats.runs != 0)
+                           ? (uint32_t)(stats.total_jitter_us / stats.runs)
+                           : 0;
+        uint32_t avg_step = (stats.steps != 0)
+                                ? (uint32_t)(stats.total_step_ns / stats.steps)
+                                : 0;
+        shell_print(shell, "%-8s %10u %8u %12u %12u %12u %12u",
+                    loops[i].desc->namePtr,
+                    (uint32_t)(loops[i].period_us / 1000), stats.runs,
+                    stats.last_jitter_us, stats.max_jitter_us, avg, avg_step);
+    }
+    return 0;
+}
+
+static int cmd_pid_sched_reset(const struct shell* shell, size_t argc,
+                               char** argv)
+{
+    ARG_UNUSED(shell);
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    for (uint32_t i = 0; i < loop_count; ++i)
+    {
+        loops[i].stats.runs = 0;
+        loops[i].stats.last_jitter_us = 0;
+        loops[i].stats.max_jitter_us = 0;
+        loops[i].stats.total_jitter_us = 0;
+        loops[i].stats.steps = 0;
+        loops[i].stats.max_step_ns = 0;
+        loops[i].stats.total_step_ns = 0;
+    }
+    k_spin_unlock(&stats_lock, key);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_pid_sched,
+    SHELL_CMD(stats, NULL, "Show per loop period jitter", cmd_pid_sched_stats),
+    SHELL_CMD(reset, NULL, "Reset jitter statistics", cmd_pid_sched_reset),
+    SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(pid_sched, &sub_pid_sched, "PID scheduler commands", NULL);
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PID_SCHED_H_
+#define PID_SCHED_H_
+
+#include <smc/pid.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Runtime tunable parameters of a loop.
+ */
+struct pid_sched_params
+{
+    float setpoint;
+    float kP;
+    float kI;
+    float kD;
+};
+
+/**
+ * @brief Per loop scheduling configuration.
+ *
+ * A period_ms of 0 falls back to the descriptor's `info.ts` (seconds).
+ *
+ * The scheduler samples the loop input through input rather than through
+ * the descriptor, whose input handler is left to the smc-common FSM. Point
+ * the descriptor at a handler returning pid_sched_stats.input so the FSM
+ * sweep does not sample the sensors a second time.
+ *
+ * A loop with a non zero event_delta is event triggered: it is also
+ * evaluated as soon as one of event_sensors is reported, through
+ * pid_sched_notify(), to have moved by event_delta or more since it last
+ * triggered. period_ms is then the longest interval between evaluations.
+ *
+ * Parameters staged with pid_sched_stage_params() must lie within
+ * [params_min, params_max].
+ */
+struct pid_sched_cfg
+{
+    pid_hdl_t input;
+    uint32_t period_ms;
+
+    float event_delta;
+    // Sensors the loop input depends on.
+    const uint32_t* event_sensors;
+    size_t event_sensor_count;
+
+    struct pid_sched_params params_min;
+    struct pid_sched_params params_max;
+};
+
+/**
+ * @brief Per loop timing statistics.
+ *
+ * Jitter is the difference between the time a loop actually ran and the
+ * deadline it was scheduled for. Step cost is the CPU time spent in the PID
+ * computation of the loop.
+ */
+struct pid_sched_stats
+{
+    uint32_t runs;
+    uint32_t period_us;
+    uint32_t last_jitter_us;
+    uint32_t max_jitter_us;
+    uint64_t total_jitter_us;
+
+    uint32_t steps;
+    uint32_t max_step_ns;
+    uint64_t total_step_ns;
+
+    // Last input sampled by the loop.
+    float input;
+    // Last output of the loop, and whether it sits on the lower output limit.
+    float output;
+    bool output_at_min;
+};
+
+/**
+ * @brief Called by the scheduler after a loop produced a new output.
+ *
+ * @param index index of the loop in the descriptor table.
+ * @param output new (clamped) output of the loop.
+ */
+typedef void (*pid_sched_output_t)(uint32_t index, float output);
+
+/**
+ * @brief Start the deadline driven PID scheduler.
+ *
+ * Each loop in desc is evaluated on its own period instead of on a fixed
+ * sweep. The scheduler thread sleeps until the earliest deadline.
+ *
+ * @param desc PID descriptor table. Gains, limits, setpoint and input handlers
+ * are read from here on every evaluation.
+ * @param cfg scheduling configuration, one entry per loop.
+ * @param count number of loops in desc and cfg.
+ * @param output callback invoked with every new loop output.
+ * @param resume restore the integrator and output of every loop from the
+ * retained state, see pid_sched_can_resume(). The restored outputs are
+ * reported through output before this returns.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int pid_sched_start(pid_desc_t* desc, const struct pid_sched_cfg* cfg,
+                    size_t count, pid_sched_output_t output, bool resume);
+
+/**
+ * @brief Report a new sensor value to the event triggered loops.
+ *
+ * Cheap enough to call from every sensor write. Loops that depend on the
+ * sensor and whose event_delta is crossed are evaluated right away on the
+ * scheduler thread.
+ *
+ * @param sensor_id sensor that was written.
+ * @param value new value.
+ */
+void pid_sched_notify(uint32_t sensor_id, float value);
+
+/**
+ * @brief Whether the loop state retained from before the last reset is valid.
+ *
+ * The integrator and last output of every loop are kept in a no-init RAM
+ * section protected by a CRC. They survive a watchdog reset but not a power
+ * cycle.
+ *
+ * @param count number of loops the caller is about to start.
+ */
+bool pid_sched_can_resume(size_t count);
+
+/**
+ * @brief Stage new parameters for a loop.
+ *
+ * The parameters are written to a shadow block and picked up by the scheduler
+ * thread right before the next step of that loop, so a step never runs with a
+ * mix of old and new values. The scheduler never waits on this call: if it
+ * races with a write in progress it keeps the current parameters for one more
+ * step. The descriptor is updated when the parameters are applied.
+ *
+ * @return 0 on success, -EINVAL if a parameter is not finite or outside the
+ * loop's [params_min, params_max], other negative value if index is out of
+ * range.
+ */
+int pid_sched_stage_params(uint32_t index,
+                           const struct pid_sched_params* params);
+
+/**
+ * @brief Get the parameters a loop is running with, or has staged.
+ *
+ * Staged parameters are returned until the scheduler applies them. Otherwise
+ * the values are read from the descriptor, so changes made directly to it,
+ * e.g. through setPIDparam(), are seen.
+ *
+ * @return 0 on success, negative value if index is out of range.
+ */
+int pid_sched_get_params(uint32_t index, struct pid_sched_params* params);
+
+/**
+ * @brief Get a snapshot of the timing statistics of a loop.
+ *
+ * @return 0 on success, negative value if index is out of range.
+ */
+int pid_sched_get_stats(uint32_t index, struct pid_sched_stats* stats);
+
+#endif /* PID_SCHED_H_ */
@@ -14,10 +14,22 @@
  * limitations under the License.
  */
 
+#include "adc_scan.h"
+#include "fan_rpm_ctl.h"
+#include "fan_tach.h"
+#include "platform.h"
 #include "platform_cfg.h"
+#include "poll_sched.h"
 #include "rde_resources.h"
+#include "sensor_event.h"
+#include "sensor_filter.h"
+#include "sensor_store.h"
+#include "topology.h"
+
+#ifdef CONFIG_SMC_THERMAL_SIM
+#include "sim/thermal_sim.h"
+#endif
 
-#include <smc/adc_sensor.h>
 #include <smc/fan_sensor.h>
 
 extern int install_smc_thermal_ctl();
@@ -70,18 +82,18 @@ static struct adc_sensor_ctx adc_sensor_list[] = {
 static int smc_sensors_init_adc(const struct device* dev)
 {
     ARG_UNUSED(dev);
-    return adc_sensor_monitor(adc_sensor_list, ARRAY_SIZE(adc_sensor_list));
+    return adc_scan_monitor(adc_sensor_list, ARRAY_SIZE(adc_sensor_list));
 }
 SYS_INIT(smc_sensors_init_adc, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 
 /**
- * @brief Initializing a fan
+ * @brief Initializing the fans
  *
- * If a tach sensor is available it can be added here as well. Also it should be
- * initialized in the board file.
+ * The tach entries are left empty, tachs are measured by fan_tach from
+ * fan_tach_list.
  */
 static struct smc_fan_sensor_ctx fan_sensor_list[] = {
-    {
+    [SMC_FAN_0] = {
         .tach =
             {
                 .dev_label = "",
@@ -100,67 +112,217 @@ static struct smc_fan_sensor_ctx fan_sensor_list[] = {
                 .pwm_index = 0,
             },
     },
+    [SMC_FAN_1] = {
+        .tach =
+            {
+                .dev_label = "",
+            },
+        .duty =
+            {
+                .dev_label = "PWM",
+                .id = SMC_SENSOR_DUTY_FAN1,
+                .name = "fan1_duty",
+                .channel_num = SENSOR_CHAN_DUTY_CYCLE,
+                .max = MAX_FAN_DUTY,
+                .min = MIN_FAN_DUTY,
+                .default_duty = 65,
+                .poll_rate_ms = 0,
+                .unit = percent,
+                .pwm_index = 1,
+            },
+    },
 };
+_Static_assert(ARRAY_SIZE(fan_sensor_list) == SMC_FAN_N,
+               "fan_sensor_list must describe every fan");
+
+/**
+ * @brief Tach capture input of each fan in fan_sensor_list.
+ *
+ * On the simulated tray the emulated capture device reports the simulated fan
+ * speeds.
+ */
+#ifdef CONFIG_SMC_THERMAL_SIM
+#define SMC_TACH_DEV_LABEL "TACH_EMUL"
+#else
+#define SMC_TACH_DEV_LABEL "PWM"
+#endif
+
+static const struct fan_tach_cfg fan_tach_list[] = {
+    [SMC_FAN_0] =
+        {
+            .dev_label = SMC_TACH_DEV_LABEL,
+            .channel = 0,
+            .sensor_id = SMC_SENSOR_TACH_FAN,
+            .name = "fan_tach",
+            .pulses_per_rev = 2,
+            .max_rpm = 12000,
+        },
+    [SMC_FAN_1] =
+        {
+            .dev_label = SMC_TACH_DEV_LABEL,
+            .channel = 1,
+            .sensor_id = SMC_SENSOR_TACH_FAN1,
+            .name = "fan1_tach",
+            .pulses_per_rev = 2,
+            .max_rpm = 12000,
+        },
+};
+_Static_assert(ARRAY_SIZE(fan_tach_list) == SMC_FAN_N,
+               "fan_tach_list must describe every fan");
+
+/**
+ * @brief Inner RPM loop of each fan in fan_sensor_list.
+ *
+ * Fans without a tach sensor are driven open loop.
+ */
+static const struct fan_rpm_ctl_cfg fan_rpm_cfg_list[] = {
+    [SMC_FAN_0] =
+        {
+            .duty_sensor = SMC_SENSOR_DUTY_FAN,
+            .tach_sensor = SMC_SENSOR_TACH_FAN,
+            .max_rpm = 12000,
+            .min_rpm = 300,
+            .kP = 0.002,
+            .kI = 0.004,
+            .trim_limit = 25.0,
+        },
+    [SMC_FAN_1] =
+        {
+            .duty_sensor = SMC_SENSOR_DUTY_FAN1,
+            .tach_sensor = SMC_SENSOR_TACH_FAN1,
+            .max_rpm = 12000,
+            .min_rpm = 300,
+            .kP = 0.002,
+            .kI = 0.004,
+            .trim_limit = 25.0,
+        },
+};
+_Static_assert(ARRAY_SIZE(fan_rpm_cfg_list) == SMC_FAN_N,
+               "fan_rpm_cfg_list must describe every fan");
+
 static int smc_init_fan(const struct device* dev)
 {
     ARG_UNUSED(dev);
-    return fan_sensor_init(fan_sensor_list, ARRAY_SIZE(fan_sensor_list));
+    RETURN_IF_IERROR(
+        fan_sensor_init(fan_sensor_list, ARRAY_SIZE(fan_sensor_list)));
+    RETURN_IF_IERROR(fan_tach_init(fan_tach_list, ARRAY_SIZE(fan_tach_list)));
+    return fan_rpm_ctl_init(fan_rpm_cfg_list, ARRAY_SIZE(fan_rpm_cfg_list));
 }
 SYS_INIT(smc_init_fan, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 
 /**
- * @brief Initialize several dummy sensors
+ * @brief Poll the dummy sensors.
+ *
+ * There is no device behind them: the smc-common reading, written by the host,
+ * stands in for the device register a real sensor would
+ * read here. It holds the raw value and is never written back, the filtered
+ * value is only published to the sensor store.
+ */
+static void smc_poll_dummy_sensors(const uint32_t* sensors, size_t count,
+                                   void* ctx)
+{
+    ARG_UNUSED(ctx);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float value;
+        if (get_sensor_calibrated_reading(sensors[i], &value) == 0)
+        {
+            sensor_store_update(sensors[i],
+                                sensor_filter_apply(sensors[i], value));
+        }
+        else
+        {
+            sensor_filter_reset(sensors[i]);
+            sensor_store_fail(sensors[i]);
+        }
+    }
+}
+
+static uint32_t dummy_sensor_list[SMC_SENSOR_N];
+
+/**
+ * @brief Initialize the dummy sensors of the topology
+ *
+ * The sensors are registered without a poll rate and polled in batches by
+ * the poll scheduler. On the simulated tray the sensors published by the
+ * simulator are registered but not polled.
  */
 static int smc_init_dummy_sensors(const struct device* dev)
 {
     ARG_UNUSED(dev);
 
-    sensor_register_by_id(SMC_SENSOR_CURRENT, /*device=*/NULL, "current_sensor",
-                          /*max=*/10, /*min=*/0,
-                          /*poll_rate_ms=*/1000,
-                          /*write_protect=*/true, amp,
-                          /*gain=*/1, /*offset=*/0);
-    set_sensor_reading_float(SMC_SENSOR_CURRENT, 2.55);
-
-    sensor_register_by_id(SMC_SENSOR_TEMP, /*device=*/NULL, "tray_temp",
-                          /*max=*/80, /*min=*/5,
-                          /*poll_rate_ms=*/1000,
-                          /*write_protect=*/true, CELSIUS,
-                          /*gain=*/1, /*offset=*/0);
-    set_sensor_reading_float(SMC_SENSOR_TEMP, 33.0);
-
-    sensor_register_by_id(SMC_SENSOR_POW, /*device=*/NULL, "tray_power",
-                          /*max=*/500, /*min=*/0,
-                          /*poll_rate_ms=*/1000,
-                          /*write_protect=*/true, watt,
-                          /*gain=*/1, /*offset=*/0);
-    set_sensor_reading_float(SMC_SENSOR_POW, 250.0);
-
-    sensor_register_by_id(SMC_SENSOR_TACH_FAN, /*device=*/NULL, "fan_tach",
-                          /*max=*/12000, /*min=*/100,
-                          /*poll_rate_ms=*/1000,
-                          /*write_protect=*/true, rpm,
-                          /*gain=*/1, /*offset=*/0);
-    set_sensor_reading_float(SMC_SENSOR_TACH_FAN, 8000);
-
-    sensor_register_by_id(SMC_SENSOR_HDD0_TEMP, /*device=*/NULL, "hdd0_temp",
-                          /*max=*/70, /*min=*/10,
-                          /*poll_rate_ms=*/1000,
-                          /*write_protect=*/true, CELSIUS,
-                          /*gain=*/1, /*offset=*/0);
-    set_sensor_reading_float(SMC_SENSOR_HDD0_TEMP, 39.0);
-
-    sensor_register_by_id(SMC_SENSOR_HDD1_TEMP, /*device=*/NULL, "hdd1_temp",
-                          /*max=*/70, /*min=*/10,
-                          /*poll_rate_ms=*/1000,
-                          /*write_protect=*/true, CELSIUS,
-                          /*gain=*/1, /*offset=*/0);
-    set_sensor_reading_float(SMC_SENSOR_HDD1_TEMP, 40.0);
+    size_t polled = 0;
+    for (size_t i = 0; i < topology_dummy_sensor_count; ++i)
+    {
+        const struct topology_dummy_sensor* sensor = &topology_dummy_sensors[i];
+
+        RETURN_IF_IERROR(sensor_register_by_id(
+            sensor->sensor_id, /*device=*/NULL, sensor->name, sensor->max,
+            sensor->min, /*poll_rate_ms=*/0, /*write_protect=*/true,
+            sensor->unit, /*gain=*/1, /*offset=*/0));
+        set_sensor_reading_float(sensor->sensor_id, sensor->initial);
+#ifdef CONFIG_SMC_THERMAL_SIM
+        if (thermal_sim_owns_sensor(sensor->sensor_id))
+        {
+            continue;
+        }
+#endif
+        dummy_sensor_list[polled++] = sensor->sensor_id;
+    }
 
+    for (size_t i = 0; i < polled; i += CONFIG_SMC_POLL_SCHED_BATCH_SIZE)
+    {
+        size_t count = MIN(polled - i, CONFIG_SMC_POLL_SCHED_BATCH_SIZE);
+        RETURN_IF_IERROR(poll_sched_add(&dummy_sensor_list[i], count,
+                                        /*period_ms=*/1000,
+                                        smc_poll_dummy_sensors, NULL));
+    }
     return 0;
 }
 SYS_INIT(smc_init_dummy_sensors, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 
+static int smc_init_sensor_events(const struct device* dev)
+{
+    ARG_UNUSED(dev);
+    return sensor_event_init(topology_sensor_thresholds,
+                             topology_sensor_threshold_count);
+}
+SYS_INIT(smc_init_sensor_events, APPLICATION,
+         CONFIG_APPLICATION_INIT_PRIORITY);
+
+/**
+ * @brief Conditioning of the raw readings, applied by the sensor pollers
+ * before a reading is published.
+ *
+ * The temperatures feed the PID loops and the thresholds and are not
+ * filtered, a lag there delays the fan response. The tray power feeding the
+ * feed-forward only goes through a short median, which rejects single spikes
+ * without slowing down a power step. The tach readings are already the median
+ * of a poll's periods, and a stalled fan must read 0 RPM at the poll that
+ * detects the stall, so they are not filtered either.
+ */
+static const struct sensor_filter_cfg sensor_filter_list[] = {
+    {
+        .sensor_id = SMC_SENSOR_VOLTAGE,
+        .median_len = 5,
+        .ema_shift = 2,
+    },
+    {
+        .sensor_id = SMC_SENSOR_POW,
+        .median_len = 3,
+    },
+};
+
+static int smc_init_sensor_filters(const struct device* dev)
+{
+    ARG_UNUSED(dev);
+    return sensor_filter_init(sensor_filter_list,
+                              ARRAY_SIZE(sensor_filter_list));
+}
+SYS_INIT(smc_init_sensor_filters, APPLICATION,
+         CONFIG_APPLICATION_INIT_PRIORITY);
+
 /**
  * @brief Initialize PID control
  */
@@ -181,3 +343,12 @@ int platform_set_hdd_power_state(uint16_t hdd_index, bool power)
     hdd_power_state[hdd_index] = power;
     return 0;
 }
+
+bool platform_get_hdd_power_state(uint16_t hdd_index)
+{
+    if (hdd_index >= SMC_DRIVE_N)
+    {
+        return false;
+    }
+    return hdd_power_state[hdd_index];
+}
@@ -22,4 +22,13 @@
 
 int platform_set_hdd_power_state(uint16_t hdd_index, bool power);
 
+bool platform_get_hdd_power_state(uint16_t hdd_index);
+
+/**
+ * @brief Whether the last reset was caused by the watchdog.
+ *
+ * Valid once the POST_KERNEL watchdog init has run.
+ */
+bool platform_wdt_reset_detected(void);
+
 #endif /* PLATFORM_H_ */
@@ -17,6 +17,8 @@
 #ifndef PLATFORM_CFG_H_
 #define PLATFORM_CFG_H_
 
+#include "topology_ids.h"
+
 /**
  * @brief Manager resource enums.
  */
@@ -45,42 +47,17 @@ _Static_assert(
     CONFIG_SMC_RDE_SOFTWARE_INVENTORY_COUNT == RDE_SOFTWARE_INVENTORY_N,
     "Allocated software inventories count not equal to the defined software inventories count");
 
-enum rde_chassis_id
-{
-    RDE_CHASSIS_TRAY = 0,
-    RDE_CHASSIS_SATA_0,
-    RDE_CHASSIS_SATA_1,
-
-    // Number of possible chassis for the platform.
-    RDE_CHASSIS_N,
-};
+/**
+ * Chassis (rde_chassis_id), sensor (smc_sensor_id) and drive (smc_drive_id)
+ * enums are generated from topology/tray.json by scripts/gen_topology.py.
+ */
 _Static_assert(
     CONFIG_SMC_RDE_CHASSIS_COUNT == RDE_CHASSIS_N,
     "Allocated chassis count not equal to the defined chassis count");
-
-/**
- * @brief Sensor enums.
- *
- * Only the sensors supported by redfish should be added to this list. Adding a
- * member to this list will result in creating storage for the redfish
- * representation of the senor.
- */
-enum smc_sensor_id
-{
-    SMC_SENSOR_VOLTAGE = 0,
-    SMC_SENSOR_CURRENT,
-    SMC_SENSOR_TEMP,
-    SMC_SENSOR_POW,
-    SMC_SENSOR_TACH_FAN,
-    SMC_SENSOR_DUTY_FAN,
-    SMC_SENSOR_HDD0_TEMP,
-    SMC_SENSOR_HDD1_TEMP,
-
-    // Number of possible sensors on the platform.
-    SMC_SENSOR_N,
-};
 _Static_assert(CONFIG_SMC_SENSOR_N == SMC_SENSOR_N,
                "Allocated sensor count not equal to the defined sensors count");
+_Static_assert(CONFIG_SMC_RDE_DRIVE_COUNT == SMC_DRIVE_N,
+               "Allocated drive count not equal to the defined drive count");
 
 /**
  * @brief Thermal and fan control loops
@@ -114,15 +91,20 @@ _Static_assert(CONFIG_SMC_RDE_TEMP_PID_CONTROL_COUNT == SMC_PID_CONTROL_N,
  */
 #define SMC_CLOSED_LOOP_PID_CNT (SMC_PID_CONTROL_HDD + 1)
 
-enum smc_drive_id
+/**
+ * @brief Fan enums.
+ *
+ * The fan index is the index into fan_sensor_list and the index used by
+ * fan_set_duty_by_id.
+ */
+enum smc_fan_id
 {
-    SMC_DRIVE_ID_0 = 0,
-    SMC_DRIVE_ID_1,
+    SMC_FAN_0 = 0,
+    SMC_FAN_1,
 
-    SMC_DRIVE_N
+    // Number of fans on the platform.
+    SMC_FAN_N,
 };
-_Static_assert(CONFIG_SMC_RDE_DRIVE_COUNT == SMC_DRIVE_N,
-               "Allocated drive count not equal to the defined drive count");
 
 /**
  * @brief Storage subsystem index
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "poll_sched.h"
+
+#include <kernel.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <smc/utils.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(poll_sched, LOG_LEVEL_WRN);
+
+#define POLL_SCHED_TICK_MS CONFIG_SMC_POLL_SCHED_TICK_MS
+#define POLL_SCHED_SLOTS CONFIG_SMC_POLL_SCHED_WHEEL_SLOTS
+
+_Static_assert(CONFIG_SMC_POLL_SCHED_MAX_BATCHES < UINT8_MAX,
+               "batch links are 8 bit");
+
+/**
+ * @brief Sensors polled together by one callback.
+ *
+ * Batches hang off the wheel slot of their due tick. A batch whose period is
+ * longer than the wheel stays in its slot for several revolutions, it is only
+ * run when due_tick is reached.
+ */
+struct poll_sched_batch
+{
+    poll_sched_fn_t fn;
+    void* ctx;
+    uint32_t period_ticks;
+    uint32_t due_tick;
+    uint32_t runs;
+
+    uint32_t sensors[CONFIG_SMC_POLL_SCHED_BATCH_SIZE];
+    uint8_t sensor_count;
+
+    // Next batch in the same slot, 1-based, 0 ends the list.
+    uint8_t next;
+};
+
+static struct poll_sched_batch batches[CONFIG_SMC_POLL_SCHED_MAX_BATCHES];
+static uint8_t batch_count;
+
+// Head of every slot, 1-based, 0 for an empty slot.
+static uint8_t wheel[POLL_SCHED_SLOTS];
+// Number of sensors polled on each slot during one revolution.
+static uint16_t slot_load[POLL_SCHED_SLOTS];
+
+// Next tick to process, counted from epoch_ms.
+static uint32_t tick;
+static int64_t epoch_ms;
+
+K_MUTEX_DEFINE(poll_sched_lock);
+
+static void poll_sched_work_handler(struct k_work* work);
+K_WORK_DELAYABLE_DEFINE(poll_sched_work, poll_sched_work_handler);
+
+static void poll_sched_link(uint8_t index)
+{
+    struct poll_sched_batch* batch = &batches[index];
+    uint32_t slot = batch->due_tick % POLL_SCHED_SLOTS;
+
+    batch->next = wheel[slot];
+    wheel[slot] = index + 1;
+}
+
+/**
+ * @brief Sensor load of the slots a batch would hit in one revolution if it
+ * was first due offset ticks from now.
+ */
+static uint32_t poll_sched_phase_load(uint32_t offset, uint32_t period_ticks)
+{
+    uint32_t load = 0;
+    for (uint32_t t = offset; t < POLL_SCHED_SLOTS; t += period_ticks)
+    {
+        load += slot_load[(tick + t) % POLL_SCHED_SLOTS];
+    }
+    return load;
+}
+
+static void poll_sched_add_load(uint32_t offset, uint32_t period_ticks,
+                                uint32_t sensors)
+{
+    for (uint32_t t = offset; t < POLL_SCHED_SLOTS; t += period_ticks)
+    {
+        slot_load[(tick + t) % POLL_SCHED_SLOTS] += sensors;
+    }
+}
+
+/**
+ * @brief Pick the least loaded first due tick for a new batch.
+ */
+static uint32_t poll_sched_stagger(uint32_t period_ticks, uint32_t sensors)
+{
+    uint32_t phases = MIN(period_ticks, POLL_SCHED_SLOTS);
+    uint32_t best = 0;
+    uint32_t best_load = UINT32_MAX;
+
+    for (uint32_t offset = 0; offset < phases; ++offset)
+    {
+        uint32_t load = poll_sched_phase_load(offset, period_ticks);
+        if (load < best_load)
+        {
+            best = offset;
+            best_load = load;
+        }
+    }
+
+    poll_sched_add_load(best, period_ticks, sensors);
+    return tick + best;
+}
+
+/**
+ * @brief Run every batch due on tick t and move it to its next slot.
+ *
+ * The next due tick is the first one after now_tick on the batch's phase, so
+ * a batch whose periods were missed by a late work item runs once instead of
+ * once per missed period.
+ */
+static void poll_sched_run_tick(uint32_t t, uint32_t now_tick)
+{
+    uint32_t slot = t % POLL_SCHED_SLOTS;
+    uint8_t due[CONFIG_SMC_POLL_SCHED_MAX_BATCHES];
+    size_t due_count = 0;
+
+    uint8_t* link = &wheel[slot];
+    while (*link != 0)
+    {
+        uint8_t index = *link - 1;
+        struct poll_sched_batch* batch = &batches[index];
+
+        if (batch->due_tick == t)
+        {
+            *link = batch->next;
+            due[due_count++] = index;
+        }
+        else
+        {
+            link = &batch->next;
+        }
+    }
+
+    for (size_t i = 0; i < due_count; ++i)
+    {
+        struct poll_sched_batch* batch = &batches[due[i]];
+
+        batch->fn(batch->sensors, batch->sensor_count, batch->ctx);
+        batch->runs++;
+        batch->due_tick += batch->period_ticks;
+        if ((int32_t)(now_tick - batch->due_tick) >= 0)
+        {
+            uint32_t missed = (now_tick - batch->due_tick) /
+                              batch->period_ticks;
+            batch->due_tick += (missed + 1) * batch->period_ticks;
+        }
+        poll_sched_link(due[i]);
+    }
+}
+
+/**
+ * @brief Find the next tick with a due batch.
+ */
+static uint32_t poll_sched_next_tick(void)
+{
+    for (uint32_t t = tick; t < tick + POLL_SCHED_SLOTS; ++t)
+    {
+        for (uint8_t link = wheel[t % POLL_SCHED_SLOTS]; link != 0;
+             link = batches[link - 1].next)
+        {
+            if (batches[link - 1].due_tick == t)
+            {
+                return t;
+            }
+        }
+    }
+
+    // Only batches slower than one revolution are left.
+    uint32_t next = UINT32_MAX;
+    for (uint8_t i = 0; i < batch_count; ++i)
+    {
+        next = MIN(next, batches[i].due_tick);
+    }
+    return next;
+}
+
+static void poll_sched_arm(void)
+{
+    int64_t at_ms = epoch_ms + ((int64_t)poll_sched_next_tick() *
+                                POLL_SCHED_TICK_MS);
+    int64_t delay_ms = MAX(at_ms - k_uptime_get(), 0);
+
+    k_work_reschedule(&poll_sched_work, K_MSEC(delay_ms));
+}
+
+static void poll_sched_work_handler(struct k_work* work)
+{
+    ARG_UNUSED(work);
+
+    k_mutex_lock(&poll_sched_lock, K_FOREVER);
+
+    // Walk every tick that elapsed, a late work item still polls each due
+    // batch once and skips its missed periods.
+    uint32_t now_tick =
+        (uint32_t)((k_uptime_get() - epoch_ms) / POLL_SCHED_TICK_MS);
+    while ((int32_t)(now_tick - tick) >= 0)
+    {
+        poll_sched_run_tick(tick, now_tick);
+        tick++;
+    }
+
+    poll_sched_arm();
+    k_mutex_unlock(&poll_sched_lock);
+}
+
+static struct poll_sched_batch* poll_sched_find(poll_sched_fn_t fn, void* ctx,
+                                                uint32_t period_ticks,
+                                                size_t count)
+{
+    for (uint8_t i = 0; i < batch_count; ++i)
+    {
+        struct poll_sched_batch* batch = &batches[i];
+        if (batch->fn == fn && batch->ctx == ctx &&
+            batch->period_ticks == period_ticks &&
+            batch->sensor_count + count <= ARRAY_SIZE(batch->sensors))
+        {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+int poll_sched_add(const uint32_t* sensors, size_t count, uint32_t period_ms,
+                   poll_sched_fn_t fn, void* ctx)
+{
+    IS_PARAM_NULL(sensors, "sensors cannot be NULL");
+    IS_PARAM_NULL(fn, "fn cannot be NULL");
+
+    if (count == 0 || count > CONFIG_SMC_POLL_SCHED_BATCH_SIZE ||
+        period_ms == 0)
+    {
+        LOG_ERR("Invalid poll request: %zu sensors every %u ms", count,
+                period_ms);
+        return -EINVAL;
+    }
+
+    uint32_t period_ticks =
+        ROUND_UP(period_ms, POLL_SCHED_TICK_MS) / POLL_SCHED_TICK_MS;
+
+    k_mutex_lock(&poll_sched_lock, K_FOREVER);
+
+    if (batch_count == 0)
+    {
+        epoch_ms = k_uptime_get();
+        tick = 0;
+    }
+
+    struct poll_sched_batch* batch =
+        poll_sched_find(fn, ctx, period_ticks, count);
+    if (batch != NULL)
+    {
+        uint32_t offset = batch->due_tick - tick;
+        poll_sched_add_load(offset % period_ticks, period_ticks, count);
+    }
+    else if (batch_count < ARRAY_SIZE(batches))
+    {
+        uint8_t index = batch_count++;
+        batch = &batches[index];
+        batch->fn = fn;
+        batch->ctx = ctx;
+        batch->period_ticks = period_ticks;
+        batch->due_tick = poll_sched_stagger(period_ticks, count);
+        poll_sched_link(index);
+    }
+    else
+    {
+        k_mutex_unlock(&poll_sched_lock);
+        LOG_ERR("No free poll batch");
+        return -ENOMEM;
+    }
+
+    memcpy(&batch->sensors[batch->sensor_count], sensors,
+           count * sizeof(sensors[0]));
+    batch->sensor_count += count;
+
+    poll_sched_arm();
+    k_mutex_unlock(&poll_sched_lock);
+    return 0;
+}
+
+static int cmd_poll_sched_show(const struct shell* shell, size_t argc,
+                               char** argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    k_mutex_lock(&poll_sched_lock, K_FOREVER);
+    shell_print(shell, "tick %u ms, now at tick %u", POLL_SCHED_TICK_MS, tick);
+    for (uint8_t i = 0; i < batch_count; ++i)
+    {
+        const struct poll_sched_batch* batch = &batches[i];
+        shell_print(shell,
+                    "batch %u: %u sensors every %u ms, next tick %u, %u runs",
+                    i, batch->sensor_count,
+                    batch->period_ticks * POLL_SCHED_TICK_MS, batch->due_tick,
+                    batch->runs);
+    }
+    k_mutex_unlock(&poll_sched_lock);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_poll_sched,
+    SHELL_CMD(show, NULL, "Show the poll batches", cmd_poll_sched_show),
+    SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(poll_sched, &sub_poll_sched, "Sensor poll scheduler",
+                   NULL);
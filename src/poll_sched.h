@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POLL_SCHED_H_
+#define POLL_SCHED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Batch poll callback.
+ *
+ * Called from the poll scheduler work item with every sensor of the batch that
+ * is due. Must not call poll_sched_add().
+ *
+ * @param sensors ids of the sensors to poll.
+ * @param count number of sensors.
+ * @param ctx context given to poll_sched_add().
+ */
+typedef void (*poll_sched_fn_t)(const uint32_t* sensors, size_t count,
+                                void* ctx);
+
+/**
+ * @brief Poll sensors from the shared timer wheel.
+ *
+ * Sensors are meant to be registered with sensor_register_by_id() with a
+ * poll_rate_ms of 0, so they have no timer of their own, then added here.
+ *
+ * Periods are rounded up to the wheel tick (CONFIG_SMC_POLL_SCHED_TICK_MS).
+ * Sensors added with the same callback, context and rounded period join an
+ * existing batch and are polled by a single call. New batches are given the
+ * least loaded phase so polls of different batches do not land on the same
+ * tick.
+ *
+ * @param sensors ids of the sensors to poll.
+ * @param count number of sensors.
+ * @param period_ms poll period.
+ * @param fn batch callback.
+ * @param ctx context passed to fn.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int poll_sched_add(const uint32_t* sensors, size_t count, uint32_t period_ms,
+                   poll_sched_fn_t fn, void* ctx);
+
+#endif /* POLL_SCHED_H_ */
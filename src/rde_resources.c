@@ -17,8 +17,10 @@
 #include "rde_resources.h"
 
 #include "platform_cfg.h"
+#include "topology.h"
 
 #include <logging/log.h>
+#include <string.h>
 
 LOG_MODULE_REGISTER(rde_init, LOG_LEVEL_ERR);
 
@@ -67,119 +69,6 @@ static struct redfish_software_inventory software_inventory_params[] = {
     },
 };
 
-static struct redfish_chassis hdd_chassis_params[] = {
-    {
-        .chassis_id = RDE_CHASSIS_SATA_0,
-        .odata_id = "/redfish/v1/Chassis/SATA_0",
-        .chassis_type = REDFISH_CHASSIS_TYPE_STORAGEENCLOSURE,
-        .id = "SATA_0",
-        .sensors_collection = "/redfish/v1/Chassis/SATA_0/Sensors",
-        .drives = {"/redfish/v1/Chassis/SATA_0/Drives/SATA_0"},
-        .hdd_index = SMC_DRIVE_ID_0,
-        .drives_collection = "/redfish/v1/Chassis/SATA_0/Drives",
-        .contained_by_chassis_id = RDE_CHASSIS_TRAY,
-        .location =
-            {
-                .location_type = REDFISH_LOCATION_TYPE_SLOT,
-                .service_label = "sas@0",
-            },
-    },
-    {
-        .chassis_id = RDE_CHASSIS_SATA_1,
-        .odata_id = "/redfish/v1/Chassis/SATA_1",
-        .chassis_type = REDFISH_CHASSIS_TYPE_STORAGEENCLOSURE,
-        .id = "SATA_1",
-        .sensors_collection = "/redfish/v1/Chassis/SATA_1/Sensors",
-        .drives = {"/redfish/v1/Chassis/SATA_1/Drives/SATA_1"},
-        .hdd_index = SMC_DRIVE_ID_1,
-        .drives_collection = "/redfish/v1/Chassis/SATA_1/Drives",
-        .contained_by_chassis_id = RDE_CHASSIS_TRAY,
-        .location =
-            {
-                .location_type = REDFISH_LOCATION_TYPE_SLOT,
-                .service_label = "sas@1",
-            },
-    },
-};
-
-static struct redfish_sensor tray_sensor_params[] = {
-    {
-        .chassis_id = RDE_CHASSIS_TRAY,
-        .sensor_id = SMC_SENSOR_VOLTAGE,
-        .odata_id = "/redfish/v1/Chassis/Tray/Sensors/Sen_voltage",
-        .id = "sen_voltage",
-        .name = "sen_voltage",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_VOLTAGE,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-    {
-        .chassis_id = RDE_CHASSIS_TRAY,
-        .sensor_id = SMC_SENSOR_CURRENT,
-        .odata_id = "/redfish/v1/Chassis/Tray/Sensors/Sen_current",
-        .id = "sen_current",
-        .name = "sen_current",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_CURRENT,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-    {
-        .chassis_id = RDE_CHASSIS_TRAY,
-        .sensor_id = SMC_SENSOR_TEMP,
-        .odata_id = "/redfish/v1/Chassis/Tray/Sensors/Sen_temperature",
-        .id = "sen_temperature",
-        .name = "sen_temperature",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_TEMPERATURE,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-    {
-        .chassis_id = RDE_CHASSIS_TRAY,
-        .sensor_id = SMC_SENSOR_POW,
-        .odata_id = "/redfish/v1/Chassis/Tray/Sensors/Sen_power",
-        .id = "sen_power",
-        .name = "sen_power",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_POWER,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-    {
-        .chassis_id = RDE_CHASSIS_TRAY,
-        .sensor_id = SMC_SENSOR_TACH_FAN,
-        .odata_id = "/redfish/v1/Chassis/Tray/Sensors/Fan_tach",
-        .id = "fan_tach",
-        .name = "fan_tach",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_ROTATIONAL,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-    {
-        .chassis_id = RDE_CHASSIS_TRAY,
-        .sensor_id = SMC_SENSOR_DUTY_FAN,
-        .odata_id = "/redfish/v1/Chassis/Tray/Sensors/Fan_duty",
-        .id = "fan_duty",
-        .name = "fan_duty",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_PERCENT,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-};
-
-static struct redfish_sensor hdd_sensor_params[] = {
-    {
-        .chassis_id = RDE_CHASSIS_SATA_0,
-        .sensor_id = SMC_SENSOR_HDD0_TEMP,
-        .odata_id = "/redfish/v1/Chassis/SATA_0/Sensors/Temp",
-        .id = "Temp",
-        .name = "Temp",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_TEMPERATURE,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-    {
-        .chassis_id = RDE_CHASSIS_SATA_1,
-        .sensor_id = SMC_SENSOR_HDD1_TEMP,
-        .odata_id = "/redfish/v1/Chassis/SATA_1/Sensors/Temp",
-        .id = "Temp",
-        .name = "Temp",
-        .reading_type = REDFISH_SENSOR_READING_TYPE_TEMPERATURE,
-        .related_item_odata_id = smc_manager_odata_id,
-    },
-};
-
 static struct redfish_control control_params[] = {
     {
         .chassis_id = RDE_CHASSIS_TRAY,
@@ -216,43 +105,6 @@ static struct redfish_control control_params[] = {
     },
 };
 
-static struct redfish_drive drive_params[] = {
-    {
-        .chassis_id = RDE_CHASSIS_SATA_0,
-        .drive_id = SMC_DRIVE_ID_0,
-        .storage_id = RDE_STORAGE_SUBSYSTEM0,
-        .odata_id = "/redfish/v1/Chassis/SATA_0/Drives/SATA_0",
-        .media_type = REDFISH_DRIVE_MEDIA_TYPE_HDD,
-        .protocol = REDFISH_PROTOCOL_SATA,
-        .id = "SATA_0",
-        .name = "SATA_0",
-        .chassis_link = "/redfish/v1/Chassis/SATA_0",
-        .reset_action =
-            {
-                .action_info = NULL,
-                .target =
-                    "/redfish/v1/Chassis/SATA_0/Drives/SATA_0/Actions/Drive.Reset",
-            },
-    },
-    {
-        .chassis_id = RDE_CHASSIS_SATA_1,
-        .drive_id = SMC_DRIVE_ID_1,
-        .storage_id = RDE_STORAGE_SUBSYSTEM0,
-        .odata_id = "/redfish/v1/Chassis/SATA_1/Drives/SATA_1",
-        .media_type = REDFISH_DRIVE_MEDIA_TYPE_HDD,
-        .protocol = REDFISH_PROTOCOL_SATA,
-        .id = "SATA_1",
-        .name = "SATA_1",
-        .chassis_link = "/redfish/v1/Chassis/SATA_1",
-        .reset_action =
-            {
-                .action_info = NULL,
-                .target =
-                    "/redfish/v1/Chassis/SATA_1/Drives/SATA_1/Actions/Drive.Reset",
-            },
-    },
-};
-
 static struct redfish_storage storage_params = {
     .storage_id = RDE_STORAGE_SUBSYSTEM0,
     .odata_id = "/redfish/v1/Storage/SATA",
@@ -275,26 +127,58 @@ static struct redfish_storage_controller storage_controller_params = {
         },
 };
 
-static int rde_create_tray_chassis(struct redfish_server* server)
+/**
+ * @brief Chassis as registered with the server.
+ *
+ * The chassis helpers keep the registered chassis and update them, so they
+ * get RAM copies of the generated tables. Indexed by rde_chassis_id.
+ */
+static struct redfish_chassis chassis_params[RDE_CHASSIS_N];
+_Static_assert(RDE_CHASSIS_N == RDE_CHASSIS_TRAY + 1 + SMC_DRIVE_N,
+               "one chassis per drive after the tray");
+
+/**
+ * @brief Register sensors from a const table.
+ *
+ * The sensor helper copies each sensor into the server storage, so the
+ * sensors go through one RAM entry and the table stays in flash.
+ */
+static int rde_register_sensors(struct redfish_server* server,
+                                const struct redfish_sensor* sensors,
+                                size_t count)
 {
-    // We only have 1 tray. So its ok to declare it here as static.
-    static struct redfish_chassis params = {0};
-    params.chassis_id = RDE_CHASSIS_TRAY;
-    params.contained_by_chassis_id = REDFISH_CHASSIS_ID_DO_NOT_EXIST;
-    params.odata_id = "/redfish/v1/Chassis/Tray";
-    params.chassis_type = REDFISH_CHASSIS_TYPE_RACKMOUNT;
-    params.managed_by = smc_manager_odata_id;
-    params.sensors_collection = "/redfish/v1/Chassis/Tray/Sensors";
-    params.controls_collection = "/redfish/v1/Chassis/Tray/Controls";
-    params.storage[0] = "/redfish/v1/Storage/SATA";
-    params.location.location_type = REDFISH_LOCATION_TYPE_SLOT;
-    params.id = "StorageTray";
-    params.name = "StorageTray";
-    params.model = "StorageTray_1";
-    params.location.service_label = "PCIE0";
+    struct redfish_sensor params;
+    for (size_t i = 0; i < count; ++i)
+    {
+        params = sensors[i];
+        RETURN_IF_IERROR(redfish_helper_register_sensors(server, &params,
+                                                         /*sensor_count=*/1));
+    }
+    return 0;
+}
 
-    RETURN_IF_IERROR(
-        redfish_helper_register_chassis(server, &params, /*chassis_count=*/1));
+/**
+ * @brief Register drives from a const table, like rde_register_sensors().
+ */
+static int rde_register_drives(struct redfish_server* server,
+                               const struct redfish_drive* drives,
+                               size_t count)
+{
+    struct redfish_drive params;
+    for (size_t i = 0; i < count; ++i)
+    {
+        params = drives[i];
+        RETURN_IF_IERROR(redfish_helper_register_drives(server, &params,
+                                                        /*drive_count=*/1));
+    }
+    return 0;
+}
+
+static int rde_create_tray_chassis(struct redfish_server* server)
+{
+    chassis_params[RDE_CHASSIS_TRAY] = topology_tray_chassis;
+    RETURN_IF_IERROR(redfish_helper_register_chassis(
+        server, &chassis_params[RDE_CHASSIS_TRAY], /*chassis_count=*/1));
     // Manager should be contained by the tray Chassis.
     RETURN_IF_IERROR(redfish_server_set_chassis_additional_contains(
         server, RDE_CHASSIS_TRAY, smc_manager_odata_id));
@@ -321,20 +205,23 @@ int rde_server_init(struct redfish_server* server)
 
     // Register tray chassis and sensors
     RETURN_IF_IERROR(rde_create_tray_chassis(server));
-    RETURN_IF_IERROR(redfish_helper_register_sensors(
-        server, tray_sensor_params, ARRAY_SIZE(tray_sensor_params)));
+    RETURN_IF_IERROR(rde_register_sensors(server, topology_tray_sensors,
+                                          topology_tray_sensor_count));
 
     // Register Controls for Tray Chassis
     RETURN_IF_IERROR(redfish_helper_register_controls(
         server, control_params, ARRAY_SIZE(control_params)));
 
     // Register HDD chassis, sensors and drives.
+    // The drive chassis follow the tray in rde_chassis_id.
+    struct redfish_chassis* hdd_chassis = &chassis_params[RDE_CHASSIS_TRAY + 1];
+    memcpy(hdd_chassis, topology_hdd_chassis, sizeof(topology_hdd_chassis));
     RETURN_IF_IERROR(redfish_helper_register_chassis(
-        server, hdd_chassis_params, ARRAY_SIZE(hdd_chassis_params)));
-    RETURN_IF_IERROR(redfish_helper_register_sensors(
-        server, hdd_sensor_params, ARRAY_SIZE(hdd_sensor_params)));
-    RETURN_IF_IERROR(redfish_helper_register_drives(server, drive_params,
-                                                    ARRAY_SIZE(drive_params)));
+        server, hdd_chassis, ARRAY_SIZE(topology_hdd_chassis)));
+    RETURN_IF_IERROR(rde_register_sensors(server, topology_hdd_sensors,
+                                          ARRAY_SIZE(topology_hdd_sensors)));
+    RETURN_IF_IERROR(rde_register_drives(server, topology_drives,
+                                         ARRAY_SIZE(topology_drives)));
 
     // Register the storage and storage controller.
     RETURN_IF_IERROR(redfish_server_register_storage(server, &storage_params));
@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include "pid_sched.h"
 #include "platform.h"
 #include "platform_cfg.h"
+#include "sensor_store.h"
 
 #include <logging/log.h>
 #include <smc/fan_sensor.h>
@@ -118,31 +120,20 @@ int redfish_get_control_runtime_info(uint16_t pid_control_id,
         case SMC_PID_CONTROL_VR:
         case SMC_PID_CONTROL_HDD:
         {
-            float value;
-            info->setpoint = REDFISH_DOUBLE_INVALID_READING;
-            info->p_coeff = REDFISH_DOUBLE_INVALID_READING;
-            info->i_coeff = REDFISH_DOUBLE_INVALID_READING;
-            info->d_coeff = REDFISH_DOUBLE_INVALID_READING;
-
-            if (getPIDparam(pid_control_id, kPID_setpoint, &value) == 0)
-            {
-                info->setpoint = value;
-            }
-
-            if (getPIDparam(pid_control_id, kPID_kP, &value) == 0)
-            {
-                info->p_coeff = value;
-            }
-
-            if (getPIDparam(pid_control_id, kPID_kI, &value) == 0)
-            {
-                info->i_coeff = value;
-            }
-
-            if (getPIDparam(pid_control_id, kPID_kD, &value) == 0)
+            // Includes a PATCH staged for the next step of the loop.
+            struct pid_sched_params params;
+            if (pid_sched_get_params(pid_control_id, &params) != 0)
             {
-                info->d_coeff = value;
+                info->setpoint = REDFISH_DOUBLE_INVALID_READING;
+                info->p_coeff = REDFISH_DOUBLE_INVALID_READING;
+                info->i_coeff = REDFISH_DOUBLE_INVALID_READING;
+                info->d_coeff = REDFISH_DOUBLE_INVALID_READING;
+                break;
             }
+            info->setpoint = params.setpoint;
+            info->p_coeff = params.kP;
+            info->i_coeff = params.kI;
+            info->d_coeff = params.kD;
             break;
         }
         default:
@@ -152,12 +143,50 @@ int redfish_get_control_runtime_info(uint16_t pid_control_id,
     return 0;
 }
 
+/**
+ * @brief Merge a PATCHed value into a staged parameter.
+ *
+ * Properties absent from the request are left at
+ * REDFISH_DOUBLE_INVALID_READING by the decoder.
+ */
+static void patch_pid_param(double value, float* param)
+{
+    if (value != REDFISH_DOUBLE_INVALID_READING)
+    {
+        *param = (float)value;
+    }
+}
+
 int redfish_set_control_runtime_cfg(
     uint16_t pid_control_id, struct redfish_control_decoder_params* params)
 {
-    ARG_UNUSED(pid_control_id);
-    ARG_UNUSED(params);
-    return 0;
+    IS_PARAM_NULL(params, "params NULL in set_control_runtime_cfg");
+
+    switch (pid_control_id)
+    {
+        case SMC_PID_CONTROL_FAN:
+            // Manual fan duty is set through the fan duty sensor.
+            return 0;
+        case SMC_PID_CONTROL_VR:
+        case SMC_PID_CONTROL_HDD:
+        {
+            // Staged for the PID thread, which applies it at its next cycle
+            // boundary without ever waiting on RDE. The properties absent
+            // from the PATCH keep their live values. pid_sched checks the
+            // result against the limits of the loop and stages nothing
+            // unless every property is valid.
+            struct pid_sched_params staged;
+            RETURN_IF_IERROR(pid_sched_get_params(pid_control_id, &staged));
+            patch_pid_param(params->setpoint, &staged.setpoint);
+            patch_pid_param(params->p_coeff, &staged.kP);
+            patch_pid_param(params->i_coeff, &staged.kI);
+            patch_pid_param(params->d_coeff, &staged.kD);
+            return pid_sched_stage_params(pid_control_id, &staged);
+        }
+        default:
+            LOG_ERR("Invalid PID control id: %d", pid_control_id);
+            return -1;
+    }
 }
 
 int redfish_get_storage_controller_runtime_info(
@@ -205,12 +234,28 @@ int redfish_get_manager_diagnostic_runtime_info(
 
 int redfish_get_sensor_reading(uint16_t sensor_id, float* val)
 {
-    return get_sensor_calibrated_reading(sensor_id, val);
+    // Served from the store so expanded collections never contend with the
+    // pollers or the PID thread.
+    struct sensor_store_reading reading;
+    RETURN_IF_IERROR(sensor_store_get(sensor_id, &reading));
+
+    switch (reading.status)
+    {
+        case SENSOR_STORE_VALID:
+            *val = reading.value;
+            return 0;
+        case SENSOR_STORE_FAILED:
+            return -EIO;
+        default:
+            return get_sensor_calibrated_reading(sensor_id, val);
+    }
 }
 
 int redfish_set_sensor_reading(uint16_t sensor_id, float val)
 {
-    return set_write_allowed_sensor_reading(sensor_id, val);
+    RETURN_IF_IERROR(set_write_allowed_sensor_reading(sensor_id, val));
+    sensor_store_update(sensor_id, val);
+    return 0;
 }
 
 int redfish_set_drive_power(uint16_t hdd_index, bool power)
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_event.h"
+
+#include "platform_cfg.h"
+
+#include <kernel.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <smc/utils.h>
+
+LOG_MODULE_REGISTER(sensor_event, LOG_LEVEL_INF);
+
+// Delay before the first retry of a failed send, doubled at every failure.
+#define SENSOR_EVENT_RETRY_MIN_MS 100
+#define SENSOR_EVENT_RETRY_MAX_MS 10000
+
+/**
+ * @brief Threshold state of one sensor. cfg is NULL if the sensor has no
+ * threshold.
+ *
+ * Only the latest crossing of a sensor is kept: pending is set while state
+ * differs from the last state sent to the host, and value/timestamp_ms are
+ * the reading that caused state. A crossing found while one is pending
+ * replaces it, so the host always ends up with the current state.
+ */
+struct sensor_event_sensor
+{
+    const struct sensor_threshold_cfg* cfg;
+    uint8_t state;
+    uint8_t reported_state;
+    bool pending;
+    float value;
+    uint32_t timestamp_ms;
+};
+
+static struct sensor_event_sensor sensors[SMC_SENSOR_N];
+static struct k_spinlock event_lock;
+
+static struct
+{
+    atomic_t queued;
+    atomic_t coalesced;
+    atomic_t sent;
+    atomic_t dropped;
+    atomic_t failed;
+} event_stats;
+
+// Only touched by the work handler.
+static uint32_t retry_delay_ms;
+
+static void sensor_event_work_handler(struct k_work* work);
+K_WORK_DELAYABLE_DEFINE(sensor_event_work, sensor_event_work_handler);
+
+/**
+ * @brief Take the pending crossing of a sensor.
+ *
+ * @return true if event was filled.
+ */
+static bool sensor_event_take(uint32_t sensor_id, struct sensor_event* event)
+{
+    struct sensor_event_sensor* sensor = &sensors[sensor_id];
+    k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+    bool pending = sensor->pending;
+    if (pending)
+    {
+        *event = (struct sensor_event){
+            .sensor_id = sensor_id,
+            .state = sensor->state,
+            .previous_state = sensor->reported_state,
+            .value = sensor->value,
+            .timestamp_ms = sensor->timestamp_ms,
+        };
+    }
+
+    k_spin_unlock(&event_lock, key);
+    return pending;
+}
+
+/**
+ * @brief Retire a crossing taken by sensor_event_take().
+ *
+ * The sensor stays pending if it crossed again while the event was sent.
+ */
+static void sensor_event_done(const struct sensor_event* event, bool sent)
+{
+    struct sensor_event_sensor* sensor = &sensors[event->sensor_id];
+    k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+    if (sent)
+    {
+        sensor->reported_state = event->state;
+    }
+    sensor->pending = sensor->state != event->state;
+
+    k_spin_unlock(&event_lock, key);
+}
+
+static void sensor_event_work_handler(struct k_work* work)
+{
+    ARG_UNUSED(work);
+
+    struct sensor_event event;
+    for (uint32_t i = 0; i < SMC_SENSOR_N; ++i)
+    {
+        if (!sensor_event_take(i, &event))
+        {
+            continue;
+        }
+
+        int ret = sensor_event_send(&event);
+        if (ret == -ENOTSUP)
+        {
+            // The transport cannot carry this event, retrying will not help.
+            atomic_inc(&event_stats.dropped);
+            LOG_WRN("Sensor %u event not supported by the transport", i);
+            sensor_event_done(&event, false);
+            continue;
+        }
+        if (ret != 0)
+        {
+            // The sensor stays pending, the retry sends its state at that
+            // time.
+            atomic_inc(&event_stats.failed);
+            retry_delay_ms =
+                CLAMP(retry_delay_ms * 2, SENSOR_EVENT_RETRY_MIN_MS,
+                      SENSOR_EVENT_RETRY_MAX_MS);
+            LOG_DBG("Sensor %u event not sent: %d, retry in %u ms", i, ret,
+                    retry_delay_ms);
+            k_work_schedule(&sensor_event_work, K_MSEC(retry_delay_ms));
+            return;
+        }
+
+        atomic_inc(&event_stats.sent);
+        retry_delay_ms = 0;
+        sensor_event_done(&event, true);
+    }
+}
+
+static uint8_t sensor_event_next_state(const struct sensor_threshold_cfg* cfg,
+                                       uint8_t state, float value)
+{
+    switch (state)
+    {
+        case SENSOR_EVENT_STATE_UPPER_WARNING:
+            if (value >= cfg->upper - cfg->hysteresis)
+            {
+                return state;
+            }
+            break;
+        case SENSOR_EVENT_STATE_LOWER_WARNING:
+            if (value <= cfg->lower + cfg->hysteresis)
+            {
+                return state;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (value >= cfg->upper)
+    {
+        return SENSOR_EVENT_STATE_UPPER_WARNING;
+    }
+    if (value <= cfg->lower)
+    {
+        return SENSOR_EVENT_STATE_LOWER_WARNING;
+    }
+    return SENSOR_EVENT_STATE_NORMAL;
+}
+
+void sensor_event_check(uint32_t sensor_id, float value)
+{
+    if (sensor_id >= SMC_SENSOR_N || sensors[sensor_id].cfg == NULL)
+    {
+        return;
+    }
+
+    struct sensor_event_sensor* sensor = &sensors[sensor_id];
+    k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+    uint8_t state = sensor_event_next_state(sensor->cfg, sensor->state, value);
+    bool crossed = state != sensor->state;
+    bool coalesced = crossed && sensor->pending;
+    if (crossed)
+    {
+        sensor->state = state;
+        sensor->value = value;
+        sensor->timestamp_ms = k_uptime_get_32();
+        sensor->pending = state != sensor->reported_state;
+    }
+
+    k_spin_unlock(&event_lock, key);
+
+    if (!crossed)
+    {
+        return;
+    }
+    atomic_inc(&event_stats.queued);
+    if (coalesced)
+    {
+        atomic_inc(&event_stats.coalesced);
+    }
+    // No-op while a retry is already scheduled, the retry picks up the new
+    // state.
+    k_work_schedule(&sensor_event_work, K_NO_WAIT);
+}
+
+int sensor_event_init(const struct sensor_threshold_cfg* cfg, size_t count)
+{
+    IS_PARAM_NULL(cfg, "cfg cannot be NULL");
+
+    if (sensor_event_send == NULL)
+    {
+        LOG_ERR("No sensor event transport, thresholds not armed");
+        return -ENOTSUP;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const struct sensor_threshold_cfg* c = &cfg[i];
+        if (c->sensor_id >= SMC_SENSOR_N ||
+            (c->lower + c->hysteresis) >= (c->upper - c->hysteresis))
+        {
+            LOG_ERR("Invalid thresholds for sensor %u", cfg[i].sensor_id);
+            return -EINVAL;
+        }
+
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        struct sensor_event_sensor* sensor = &sensors[cfg[i].sensor_id];
+        sensor->state = SENSOR_EVENT_STATE_NORMAL;
+        sensor->reported_state = SENSOR_EVENT_STATE_NORMAL;
+        sensor->cfg = &cfg[i];
+    }
+    return 0;
+}
+
+static int cmd_sensor_event_show(const struct shell* shell, size_t argc,
+                                 char** argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    for (int i = 0; i < SMC_SENSOR_N; ++i)
+    {
+        const struct sensor_event_sensor* sensor = &sensors[i];
+        if (sensor->cfg == NULL)
+        {
+            continue;
+        }
+        shell_print(shell,
+                    "sensor %d: state %u, reported %u%s, thresholds %.1f / "
+                    "%.1f",
+                    i, sensor->state, sensor->reported_state,
+                    sensor->pending ? " (pending)" : "",
+                    (double)sensor->cfg->lower, (double)sensor->cfg->upper);
+    }
+    shell_print(shell,
+                "crossings %ld, coalesced %ld, sent %ld, dropped %ld, failed "
+                "sends %ld",
+                atomic_get(&event_stats.queued),
+                atomic_get(&event_stats.coalesced),
+                atomic_get(&event_stats.sent),
+                atomic_get(&event_stats.dropped),
+                atomic_get(&event_stats.failed));
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_sensor_event,
+    SHELL_CMD(show, NULL, "Show threshold states and event counters",
+              cmd_sensor_event_show),
+    SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(sensor_event, &sub_sensor_event, "Sensor threshold events",
+                   NULL);
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_EVENT_H_
+#define SENSOR_EVENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <toolchain.h>
+
+/**
+ * @brief Threshold state of a sensor.
+ *
+ * Values match the numericSensorState event states of PLDM for Platform
+ * Monitoring and Control (DSP0248), so they can be sent as is in a
+ * PlatformEventMessage.
+ */
+enum sensor_event_state
+{
+    SENSOR_EVENT_STATE_NORMAL = 1,
+    SENSOR_EVENT_STATE_LOWER_WARNING = 5,
+    SENSOR_EVENT_STATE_UPPER_WARNING = 8,
+};
+
+/**
+ * @brief Thresholds of one sensor.
+ *
+ * A sensor enters the upper state when its reading reaches upper and leaves
+ * it once the reading drops below upper - hysteresis. The lower state
+ * mirrors it.
+ */
+struct sensor_threshold_cfg
+{
+    uint32_t sensor_id;
+    float upper;
+    float lower;
+    float hysteresis;
+};
+
+/**
+ * @brief A threshold crossing.
+ */
+struct sensor_event
+{
+    uint32_t sensor_id;
+    uint8_t state;
+    uint8_t previous_state;
+    float value;
+    uint32_t timestamp_ms;
+};
+
+/**
+ * @brief Arm thresholds on the sensors in cfg.
+ *
+ * @param cfg threshold list. Must stay valid while armed.
+ * @param count number of entries.
+ *
+ * @return 0 on success, -ENOTSUP if no sensor_event_send() is linked in,
+ * negative value otherwise. Nothing is armed on failure.
+ */
+int sensor_event_init(const struct sensor_threshold_cfg* cfg, size_t count);
+
+/**
+ * @brief Check a new reading against the thresholds of its sensor.
+ *
+ * Called from the sensor write path. A crossing is sent from a work item, so
+ * this never waits on the host link. A sensor has at most one pending
+ * crossing: a new one replaces it, so the latest state is always sent.
+ */
+void sensor_event_check(uint32_t sensor_id, float value);
+
+/**
+ * @brief Send a threshold event to the host.
+ *
+ * Provided by the platform transport, which sends a PLDM PlatformEventMessage
+ * (numericSensorState) or an RDE event over MCTP. The declaration is weak and
+ * has no default: without a transport the symbol is NULL and
+ * sensor_event_init() fails.
+ *
+ * A failed send is retried with an exponential backoff, with the sensor state
+ * at the time of the retry. -ENOTSUP drops the event without a retry.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+__weak int sensor_event_send(const struct sensor_event* event);
+
+#endif /* SENSOR_EVENT_H_ */
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_filter.h"
+
+#include "topology_ids.h"
+
+#include <kernel.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <smc/utils.h>
+#include <stdbool.h>
+
+LOG_MODULE_REGISTER(sensor_filter, LOG_LEVEL_INF);
+
+#define SENSOR_FILTER_MEDIAN_MAX CONFIG_SMC_SENSOR_FILTER_MEDIAN_MAX
+
+// The chain runs on Q16.16 fixed point values: readings up to +/-32767 units
+// with a resolution of 1/65536.
+#define SENSOR_FILTER_FRAC_BITS 16
+#define SENSOR_FILTER_ONE (1 << SENSOR_FILTER_FRAC_BITS)
+#define SENSOR_FILTER_MAX_UNITS 32767.0f
+
+typedef int32_t q16_t;
+
+/**
+ * @brief Filter state of one sensor. cfg is NULL if the sensor is not
+ * filtered.
+ */
+struct sensor_filter
+{
+    const struct sensor_filter_cfg* cfg;
+    q16_t slew_per_s;
+
+    bool seeded;
+    q16_t window[SENSOR_FILTER_MEDIAN_MAX];
+    uint8_t window_pos;
+    uint8_t window_count;
+    q16_t ema;
+    q16_t output;
+    uint32_t output_ms;
+
+    float last_raw;
+};
+
+static struct sensor_filter filters[SMC_SENSOR_N];
+
+static q16_t sensor_filter_to_q16(float value)
+{
+    value = MAX(MIN(value, SENSOR_FILTER_MAX_UNITS), -SENSOR_FILTER_MAX_UNITS);
+    return (q16_t)(value * SENSOR_FILTER_ONE);
+}
+
+static float sensor_filter_from_q16(q16_t value)
+{
+    return (float)value / SENSOR_FILTER_ONE;
+}
+
+static q16_t sensor_filter_median(struct sensor_filter* filter, q16_t value)
+{
+    uint8_t len = filter->cfg->median_len;
+
+    filter->window[filter->window_pos] = value;
+    filter->window_pos = (filter->window_pos + 1) % len;
+    if (filter->window_count < len)
+    {
+        filter->window_count++;
+    }
+
+    // Windows are a handful of samples, an insertion sort of a copy is
+    // cheaper than keeping a sorted structure.
+    q16_t sorted[SENSOR_FILTER_MEDIAN_MAX];
+    uint8_t count = filter->window_count;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        q16_t sample = filter->window[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > sample)
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = sample;
+    }
+    return sorted[count / 2];
+}
+
+static q16_t sensor_filter_slew(struct sensor_filter* filter, q16_t value,
+                                uint32_t now_ms)
+{
+    int64_t max_step =
+        ((int64_t)filter->slew_per_s * (uint32_t)(now_ms - filter->output_ms)) /
+        1000;
+    int64_t step = (int64_t)value - filter->output;
+
+    step = MAX(MIN(step, max_step), -max_step);
+    return (q16_t)(filter->output + step);
+}
+
+float sensor_filter_apply(uint32_t sensor_id, float value)
+{
+    if (sensor_id >= SMC_SENSOR_N || filters[sensor_id].cfg == NULL)
+    {
+        return value;
+    }
+
+    struct sensor_filter* filter = &filters[sensor_id];
+    const struct sensor_filter_cfg* cfg = filter->cfg;
+    uint32_t now_ms = k_uptime_get_32();
+    q16_t x = sensor_filter_to_q16(value);
+
+    filter->last_raw = value;
+
+    if (cfg->median_len > 1)
+    {
+        x = sensor_filter_median(filter, x);
+    }
+
+    if (!filter->seeded)
+    {
+        filter->ema = x;
+        filter->output = x;
+        filter->output_ms = now_ms;
+        filter->seeded = true;
+        return sensor_filter_from_q16(x);
+    }
+
+    if (cfg->ema_shift != 0)
+    {
+        // Arithmetic shift of the difference: the average moves by
+        // (x - ema) / 2^shift towards the new reading. The difference of two
+        // full scale readings overflows q16_t, so it is taken in 64 bits.
+        filter->ema += (q16_t)(((int64_t)x - filter->ema) >> cfg->ema_shift);
+        x = filter->ema;
+    }
+
+    if (filter->slew_per_s != 0)
+    {
+        x = sensor_filter_slew(filter, x, now_ms);
+    }
+
+    filter->output = x;
+    filter->output_ms = now_ms;
+    return sensor_filter_from_q16(x);
+}
+
+void sensor_filter_reset(uint32_t sensor_id)
+{
+    if (sensor_id >= SMC_SENSOR_N)
+    {
+        return;
+    }
+
+    struct sensor_filter* filter = &filters[sensor_id];
+    filter->seeded = false;
+    filter->window_pos = 0;
+    filter->window_count = 0;
+}
+
+int sensor_filter_init(const struct sensor_filter_cfg* cfg, size_t count)
+{
+    IS_PARAM_NULL(cfg, "cfg cannot be NULL");
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const struct sensor_filter_cfg* c = &cfg[i];
+        if (c->sensor_id >= SMC_SENSOR_N ||
+            c->median_len > SENSOR_FILTER_MEDIAN_MAX ||
+            c->ema_shift >= SENSOR_FILTER_FRAC_BITS || c->slew_rate < 0 ||
+            c->slew_rate > SENSOR_FILTER_MAX_UNITS)
+        {
+            LOG_ERR("Invalid filter for sensor %u", c->sensor_id);
+            return -EINVAL;
+        }
+
+        struct sensor_filter* filter = &filters[c->sensor_id];
+        filter->cfg = c;
+        filter->slew_per_s = sensor_filter_to_q16(c->slew_rate);
+        sensor_filter_reset(c->sensor_id);
+    }
+    return 0;
+}
+
+static int cmd_sensor_filter_show(const struct shell* shell, size_t argc,
+                                  char** argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    for (int i = 0; i < SMC_SENSOR_N; ++i)
+    {
+        const struct sensor_filter* filter = &filters[i];
+        if (filter->cfg == NULL)
+        {
+            continue;
+        }
+        shell_print(shell,
+                    "sensor %d: median %u, ema 1/%u, slew %.2f/s, raw %.3f, "
+                    "filtered %.3f",
+                    i, filter->cfg->median_len, 1u << filter->cfg->ema_shift,
+                    (double)filter->cfg->slew_rate, (double)filter->last_raw,
+                    (double)sensor_filter_from_q16(filter->output));
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_sensor_filter,
+    SHELL_CMD(show, NULL, "Show filter chains and last readings",
+              cmd_sensor_filter_show),
+    SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(sensor_filter, &sub_sensor_filter, "Sensor filters", NULL);
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_FILTER_H_
+#define SENSOR_FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Filter chain of one sensor.
+ *
+ * Stages run in order median, EMA, slew limit. A stage set to 0 is skipped.
+ */
+struct sensor_filter_cfg
+{
+    uint32_t sensor_id;
+
+    // Median of the last median_len raw readings. At most
+    // CONFIG_SMC_SENSOR_FILTER_MEDIAN_MAX.
+    uint8_t median_len;
+
+    // Exponential moving average with a weight of 2^-ema_shift on the new
+    // reading.
+    uint8_t ema_shift;
+
+    // Largest change of the output, in sensor units per second.
+    float slew_rate;
+};
+
+/**
+ * @brief Install filter chains on the sensors in cfg.
+ *
+ * @param cfg filter list. Must stay valid while installed.
+ * @param count number of entries.
+ *
+ * @return 0 on success, negative value otherwise.
+ */
+int sensor_filter_init(const struct sensor_filter_cfg* cfg, size_t count);
+
+/**
+ * @brief Run a raw reading through the filter chain of its sensor.
+ *
+ * Called by the poller of the sensor before it publishes the reading. Each
+ * sensor must only be filtered from a single poller. Sensors without a filter
+ * chain return value unchanged.
+ *
+ * @param sensor_id sensor from smc_sensor_id.
+ * @param value raw reading.
+ *
+ * @return filtered reading.
+ */
+float sensor_filter_apply(uint32_t sensor_id, float value);
+
+/**
+ * @brief Drop the filter state of a sensor.
+ *
+ * The next reading seeds the chain again. Called when a sensor read fails so
+ * a recovered sensor does not slew from a stale value.
+ */
+void sensor_filter_reset(uint32_t sensor_id);
+
+#endif /* SENSOR_FILTER_H_ */
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_history.h"
+
+#include "platform_cfg.h"
+
+#include <float.h>
+#include <kernel.h>
+#include <shell/shell.h>
+#include <stdlib.h>
+
+#define SENSOR_HISTORY_BUCKETS CONFIG_SMC_SENSOR_HISTORY_BUCKETS
+#define SENSOR_HISTORY_DEPTH CONFIG_SMC_SENSOR_HISTORY_DEPTH
+
+/**
+ * @brief Length of every window. A window is split in SENSOR_HISTORY_BUCKETS
+ * buckets, the oldest bucket is dropped as a whole when time moves on.
+ */
+static const struct
+{
+    const char* name;
+    uint32_t span_ms;
+} windows[SENSOR_HISTORY_WINDOW_N] = {
+    [SENSOR_HISTORY_1MIN] = {"1min", 60 * 1000},
+    [SENSOR_HISTORY_10MIN] = {"10min", 10 * 60 * 1000},
+    [SENSOR_HISTORY_1H] = {"1h", 60 * 60 * 1000},
+};
+
+struct sensor_history_bucket
+{
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+};
+
+/**
+ * @brief Buckets of one window. current is the index, in bucket widths since
+ * boot, of the most recent bucket.
+ */
+struct sensor_history_buckets
+{
+    struct sensor_history_bucket buckets[SENSOR_HISTORY_BUCKETS];
+    uint32_t current;
+};
+
+/**
+ * @brief History of one sensor.
+ */
+struct sensor_history
+{
+    struct sensor_history_buckets windows[SENSOR_HISTORY_WINDOW_N];
+
+    // Downsampled ring, each entry is the mean of one downsample period.
+    float ring[SENSOR_HISTORY_DEPTH];
+    uint16_t ring_head;
+    uint16_t ring_count;
+    uint32_t pending_period;
+    float pending_sum;
+    uint32_t pending_count;
+};
+
+static struct sensor_history history[SMC_SENSOR_N];
+static struct k_spinlock history_lock;
+
+static uint32_t bucket_width_ms(enum sensor_history_window window)
+{
+    return windows[window].span_ms / SENSOR_HISTORY_BUCKETS;
+}
+
+static void bucket_clear(struct sensor_history_bucket* bucket)
+{
+    bucket->min = FLT_MAX;
+    bucket->max = -FLT_MAX;
+    bucket->sum = 0.0f;
+    bucket->count = 0;
+}
+
+/**
+ * @brief Move a window to the bucket containing now, dropping every bucket
+ * that fell out of it.
+ */
+static void window_advance(struct sensor_history_buckets* w,
+                           enum sensor_history_window window, uint32_t now_ms)
+{
+    uint32_t index = now_ms / bucket_width_ms(window);
+    uint32_t elapsed = MIN(index - w->current, SENSOR_HISTORY_BUCKETS);
+
+    for (uint32_t i = 1; i <= elapsed; ++i)
+    {
+        bucket_clear(&w->buckets[(w->current + i) % SENSOR_HISTORY_BUCKETS]);
+    }
+    w->current = index;
+}
+
+static void ring_add(struct sensor_history* h, float value, uint32_t now_ms)
+{
+    uint32_t period = now_ms / CONFIG_SMC_SENSOR_HISTORY_DOWNSAMPLE_MS;
+
+    if (period != h->pending_period && h->pending_count != 0)
+    {
+        h->ring[h->ring_head] = h->pending_sum / h->pending_count;
+        h->ring_head = (h->ring_head + 1) % SENSOR_HISTORY_DEPTH;
+        h->ring_count = MIN(h->ring_count + 1, SENSOR_HISTORY_DEPTH);
+        h->pending_sum = 0.0f;
+        h->pending_count = 0;
+    }
+
+    h->pending_period = period;
+    h->pending_sum += value;
+    h->pending_count++;
+}
+
+void sensor_history_add(uint32_t sensor_id, float value, uint32_t timestamp_ms)
+{
+    if (sensor_id >= SMC_SENSOR_N)
+    {
+        return;
+    }
+
+    struct sensor_history* h = &history[sensor_id];
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+
+    for (int i = 0; i < SENSOR_HISTORY_WINDOW_N; ++i)
+    {
+        struct sensor_history_buckets* w = &h->windows[i];
+        window_advance(w, i, timestamp_ms);
+
+        struct sensor_history_bucket* bucket =
+            &w->buckets[w->current % SENSOR_HISTORY_BUCKETS];
+        bucket->min = MIN(bucket->min, value);
+        bucket->max = MAX(bucket->max, value);
+        bucket->sum += value;
+        bucket->count++;
+    }
+    ring_add(h, value, timestamp_ms);
+
+    k_spin_unlock(&history_lock, key);
+}
+
+int sensor_history_get_stats(uint32_t sensor_id,
+                             enum sensor_history_window window,
+                             struct sensor_history_stats* stats)
+{
+    if (sensor_id >= SMC_SENSOR_N || window >= SENSOR_HISTORY_WINDOW_N ||
+        stats == NULL)
+    {
+        return -EINVAL;
+    }
+
+    struct sensor_history_buckets* w = &history[sensor_id].windows[window];
+    float min = FLT_MAX;
+    float max = -FLT_MAX;
+    float sum = 0.0f;
+    uint32_t count = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    window_advance(w, window, k_uptime_get_32());
+    for (int i = 0; i < SENSOR_HISTORY_BUCKETS; ++i)
+    {
+        const struct sensor_history_bucket* bucket = &w->buckets[i];
+        min = MIN(min, bucket->min);
+        max = MAX(max, bucket->max);
+        sum += bucket->sum;
+        count += bucket->count;
+    }
+    k_spin_unlock(&history_lock, key);
+
+    if (count == 0)
+    {
+        return -ENODATA;
+    }
+
+    stats->min = min;
+    stats->max = max;
+    stats->mean = sum / count;
+    stats->count = count;
+    return 0;
+}
+
+int sensor_history_get_samples(uint32_t sensor_id, float* samples,
+                               size_t max_count)
+{
+    if (sensor_id >= SMC_SENSOR_N || samples == NULL)
+    {
+        return -EINVAL;
+    }
+
+    const struct sensor_history* h = &history[sensor_id];
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+
+    size_t count = MIN(max_count, h->ring_count);
+    size_t oldest =
+        (h->ring_head + SENSOR_HISTORY_DEPTH - count) % SENSOR_HISTORY_DEPTH;
+    for (size_t i = 0; i < count; ++i)
+    {
+        samples[i] = h->ring[(oldest + i) % SENSOR_HISTORY_DEPTH];
+    }
+
+    k_spin_unlock(&history_lock, key);
+    return count;
+}
+
+static int sensor_history_init(const struct device* dev)
+{
+    ARG_UNUSED(dev);
+
+    for (int s = 0; s < SMC_SENSOR_N; ++s)
+    {
+        for (int w = 0; w < SENSOR_HISTORY_WINDOW_N; ++w)
+        {
+            for (int b = 0; b < SENSOR_HISTORY_BUCKETS; ++b)
+            {
+                bucket_clear(&history[s].windows[w].buckets[b]);
+            }
+        }
+    }
+    return 0;
+}
+SYS_INIT(sensor_history_init, PRE_KERNEL_1, 0);
+
+static int cmd_sensor_history_show(const struct shell* shell, size_t argc,
+                                   char** argv)
+{
+    ARG_UNUSED(argc);
+
+    uint32_t sensor_id = strtoul(argv[1], NULL, 0);
+    if (sensor_id >= SMC_SENSOR_N)
+    {
+        shell_error(shell, "Invalid sensor %u", sensor_id);
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < SENSOR_HISTORY_WINDOW_N; ++i)
+    {
+        struct sensor_history_stats stats;
+        if (sensor_history_get_stats(sensor_id, i, &stats) != 0)
+        {
+            shell_print(shell, "%-6s no samples", windows[i].name);
+            continue;
+        }
+        shell_print(shell, "%-6s min %.2f max %.2f mean %.2f (%u samples)",
+                    windows[i].name, (double)stats.min, (double)stats.max,
+                    (double)stats.mean, stats.count);
+    }
+    return 0;
+}
+
+static int cmd_sensor_history_samples(const struct shell* shell, size_t argc,
+                                      char** argv)
+{
+    ARG_UNUSED(argc);
+
+    // Shell commands run one at a time, keep the ring off the shell stack.
+    static float samples[SENSOR_HISTORY_DEPTH];
+
+    int count = sensor_history_get_samples(strtoul(argv[1], NULL, 0), samples,
+                                           ARRAY_SIZE(samples));
+    if (count < 0)
+    {
+        shell_error(shell, "Invalid sensor %s", argv[1]);
+        return count;
+    }
+
+    // Newest sample last, one per downsampling period.
+    for (int i = 0; i < count; ++i)
+    {
+        uint32_t age_s =
+            (uint32_t)(count - i) * CONFIG_SMC_SENSOR_HISTORY_DOWNSAMPLE_MS /
+            1000;
+        shell_print(shell, "-%u s: %.2f", age_s, (double)samples[i]);
+    }
+    shell_print(shell, "%d samples", count);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_sensor_history,
+    SHELL_CMD_ARG(show, NULL, "Show the windowed statistics of <sensor id>",
+                  cmd_sensor_history_show, 2, 0),
+    SHELL_CMD_ARG(samples, NULL, "Dump the downsampled ring of <sensor id>",
+                  cmd_sensor_history_samples, 2, 0),
+    SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(sensor_history, &sub_sensor_history,
+                   "Sensor history commands", NULL);
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_HISTORY_H_
+#define SENSOR_HISTORY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Statistics windows kept for every sensor.
+ */
+enum sensor_history_window
+{
+    SENSOR_HISTORY_1MIN = 0,
+    SENSOR_HISTORY_10MIN,
+    SENSOR_HISTORY_1H,
+    SENSOR_HISTORY_WINDOW_N,
+};
+
+/**
+ * @brief Min, max and mean of the samples of a window.
+ */
+struct sensor_history_stats
+{
+    float min;
+    float max;
+    float mean;
+    uint32_t count;
+};
+
+/**
+ * @brief Add a sample to the history of a sensor.
+ *
+ * O(1): updates the current bucket of every window, and the downsampled ring.
+ *
+ * @param sensor_id sensor from smc_sensor_id.
+ * @param value sample.
+ * @param timestamp_ms uptime of the sample.
+ */
+void sensor_history_add(uint32_t sensor_id, float value, uint32_t timestamp_ms);
+
+/**
+ * @brief Get the statistics of a sensor over a window ending now.
+ *
+ * @return 0 on success, -ENODATA if the window holds no sample, other negative
+ * value on invalid arguments.
+ */
+int sensor_history_get_stats(uint32_t sensor_id,
+                             enum sensor_history_window window,
+                             struct sensor_history_stats* stats);
+
+/**
+ * @brief Copy the downsampled ring of a sensor, oldest sample first.
+ *
+ * Each entry is the mean of CONFIG_SMC_SENSOR_HISTORY_DOWNSAMPLE_MS of
+ * samples.
+ *
+ * @param sensor_id sensor from smc_sensor_id.
+ * @param samples output buffer.
+ * @param max_count size of samples.
+ *
+ * @return number of samples copied, negative value on invalid arguments.
+ */
+int sensor_history_get_samples(uint32_t sensor_id, float* samples,
+                               size_t max_count);
+
+#endif /* SENSOR_HISTORY_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_store.h"
+
+#include "pid_sched.h"
+#include "platform_cfg.h"
+#include "sensor_event.h"
+#include "sensor_history.h"
+
+#include <kernel.h>
+#include <smc/pid_sensor.h>
+
+// Size of a data cache line. Entries never share a line, so a write to one
+// sensor does not disturb readers of its neighbours.
+#define SENSOR_STORE_LINE 32
+
+/**
+ * @brief Reading of one sensor, guarded by a sequence counter.
+ *
+ * seq is odd while the entry is being written. A reader retries if seq was
+ * odd or changed while it copied the entry.
+ */
+struct sensor_store_entry
+{
+    atomic_t seq;
+    float value;
+    uint32_t timestamp_ms;
+    uint8_t status;
+} __aligned(SENSOR_STORE_LINE);
+
+static struct sensor_store_entry store[SMC_SENSOR_N];
+
+// Serializes writers so each entry only ever has a single writer. Readers
+// never take it.
+static struct k_spinlock store_write_lock;
+
+static void sensor_store_write(uint32_t sensor_id, const float* value,
+                               enum sensor_store_status status)
+{
+    struct sensor_store_entry* entry = &store[sensor_id];
+    k_spinlock_key_t key = k_spin_lock(&store_write_lock);
+
+    atomic_val_t seq = atomic_get(&entry->seq);
+    atomic_set(&entry->seq, seq + 1);
+
+    if (value != NULL)
+    {
+        entry->value = *value;
+    }
+    entry->timestamp_ms = k_uptime_get_32();
+    entry->status = status;
+
+    atomic_set(&entry->seq, seq + 2);
+    k_spin_unlock(&store_write_lock, key);
+}
+
+void sensor_store_update(uint32_t sensor_id, float value)
+{
+    if (sensor_id >= SMC_SENSOR_N)
+    {
+        return;
+    }
+
+    sensor_store_write(sensor_id, &value, SENSOR_STORE_VALID);
+    sensor_history_add(sensor_id, value, k_uptime_get_32());
+    sensor_event_check(sensor_id, value);
+    pid_sched_notify(sensor_id, value);
+}
+
+void sensor_store_fail(uint32_t sensor_id)
+{
+    if (sensor_id >= SMC_SENSOR_N)
+    {
+        return;
+    }
+
+    sensor_store_write(sensor_id, NULL, SENSOR_STORE_FAILED);
+}
+
+int sensor_store_get(uint32_t sensor_id, struct sensor_store_reading* reading)
+{
+    if (sensor_id >= SMC_SENSOR_N)
+    {
+        return -EINVAL;
+    }
+
+    const struct sensor_store_entry* entry = &store[sensor_id];
+    atomic_val_t begin;
+    atomic_val_t end;
+
+    do
+    {
+        begin = atomic_get(&entry->seq);
+        reading->value = entry->value;
+        reading->timestamp_ms = entry->timestamp_ms;
+        reading->status = entry->status;
+        compiler_barrier();
+        end = atomic_get(&entry->seq);
+    } while ((begin & 1) || (begin != end));
+
+    return 0;
+}
+
+float sensor_store_value_or(uint32_t sensor_id, uint32_t max_age_ms,
+                            float fallback)
+{
+    struct sensor_store_reading reading;
+
+    if ((sensor_store_get(sensor_id, &reading) != 0) ||
+        (reading.status != SENSOR_STORE_VALID) ||
+        (k_uptime_get_32() - reading.timestamp_ms > max_age_ms))
+    {
+        return fallback;
+    }
+    return reading.value;
+}
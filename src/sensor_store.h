@@ -0,0 +1,89 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_STORE_H_
+#define SENSOR_STORE_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Status of the reading held for a sensor.
+ */
+enum sensor_store_status
+{
+    // Nothing was published for the sensor yet.
+    SENSOR_STORE_EMPTY = 0,
+    SENSOR_STORE_VALID,
+    // The last poll of the sensor failed, value is the last good reading.
+    SENSOR_STORE_FAILED,
+};
+
+/**
+ * @brief Snapshot of the reading of a sensor.
+ */
+struct sensor_store_reading
+{
+    float value;
+    // Uptime of the last update, in milliseconds.
+    uint32_t timestamp_ms;
+    enum sensor_store_status status;
+};
+
+/**
+ * @brief Publish a new reading.
+ *
+ * Updates the store, adds the value to the sensor history, checks it against
+ * the sensor thresholds and reports it to the event triggered PID loops.
+ * Callers still write the reading to the smc-common sensor themselves.
+ *
+ * @param sensor_id sensor from smc_sensor_id.
+ * @param value new reading.
+ */
+void sensor_store_update(uint32_t sensor_id, float value);
+
+/**
+ * @brief Mark the reading of a sensor as failed, keeping the last value.
+ */
+void sensor_store_fail(uint32_t sensor_id);
+
+/**
+ * @brief Read a consistent snapshot of a sensor reading.
+ *
+ * Lock free: never blocks and never delays a writer, it only retries if it
+ * raced with an update.
+ *
+ * @return 0 on success, negative value if sensor_id is out of range.
+ */
+int sensor_store_get(uint32_t sensor_id, struct sensor_store_reading* reading);
+
+/**
+ * @brief Last published value of a sensor, if it is current.
+ *
+ * Control inputs must not run on a frozen reading: a sensor whose last poll
+ * failed keeps its last good value in the store forever.
+ *
+ * @param sensor_id sensor from smc_sensor_id.
+ * @param max_age_ms largest age of a usable reading.
+ * @param fallback value returned when the sensor has no reading yet, its
+ * last poll failed or its reading is older than max_age_ms. Pick it so the
+ * caller fails safe, e.g. a high temperature for a cooling loop.
+ *
+ * @return the reading or fallback.
+ */
+float sensor_store_value_or(uint32_t sensor_id, uint32_t max_age_ms,
+                            float fallback);
+
+#endif /* SENSOR_STORE_H_ */
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Emulated tach capture for native_posix.
+ *
+ * A PWM capture-only device whose channel n reports the tach period of
+ * simulated fan n. Every few periods a glitch (a half period) is injected so
+ * the median filter of the tach pipeline is exercised. A fan below
+ * TACH_EMUL_MIN_RPM produces no edge at all.
+ */
+
+#include "platform_cfg.h"
+#include "thermal_sim.h"
+
+#include <device.h>
+#include <drivers/pwm.h>
+#include <kernel.h>
+
+#define TACH_EMUL_CYCLES_PER_SEC 1000000
+#define TACH_EMUL_PULSES_PER_REV 2
+#define TACH_EMUL_MIN_RPM 60.0f
+// Interval between two reported captures. Not tied to the fan speed, only
+// the reported period is.
+#define TACH_EMUL_CAPTURE_MS 5
+// One capture out of this many is a glitch.
+#define TACH_EMUL_GLITCH_EVERY 7
+
+struct tach_emul_channel
+{
+    pwm_capture_callback_handler_t cb;
+    void* user_data;
+    struct k_timer timer;
+    uint32_t captures;
+};
+
+static struct tach_emul_channel channels[SMC_FAN_N];
+
+static const struct device* tach_emul_dev;
+
+static void tach_emul_expiry(struct k_timer* timer)
+{
+    struct tach_emul_channel* ch = k_timer_user_data_get(timer);
+    uint32_t index = ch - channels;
+    float rpm = thermal_sim_fan_rpm(index);
+
+    if (ch->cb == NULL || rpm < TACH_EMUL_MIN_RPM)
+    {
+        return;
+    }
+
+    uint32_t period = (uint32_t)((60.0f * TACH_EMUL_CYCLES_PER_SEC) /
+                                 (rpm * TACH_EMUL_PULSES_PER_REV));
+    if ((++ch->captures % TACH_EMUL_GLITCH_EVERY) == 0)
+    {
+        period /= 2;
+    }
+
+    ch->cb(tach_emul_dev, index, period, period / 2, 0, ch->user_data);
+}
+
+static int tach_emul_pin_set(const struct device* dev, uint32_t pwm,
+                             uint32_t period_cycles, uint32_t pulse_cycles,
+                             pwm_flags_t flags)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(pwm);
+    ARG_UNUSED(period_cycles);
+    ARG_UNUSED(pulse_cycles);
+    ARG_UNUSED(flags);
+
+    return -ENOTSUP;
+}
+
+static int tach_emul_configure_capture(const struct device* dev, uint32_t pwm,
+                                       pwm_flags_t flags,
+                                       pwm_capture_callback_handler_t cb,
+                                       void* user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(flags);
+
+    if (pwm >= ARRAY_SIZE(channels))
+    {
+        return -EINVAL;
+    }
+
+    channels[pwm].cb = cb;
+    channels[pwm].user_data = user_data;
+    return 0;
+}
+
+static int tach_emul_enable_capture(const struct device* dev, uint32_t pwm)
+{
+    ARG_UNUSED(dev);
+
+    if (pwm >= ARRAY_SIZE(channels))
+    {
+        return -EINVAL;
+    }
+
+    k_timer_start(&channels[pwm].timer, K_MSEC(TACH_EMUL_CAPTURE_MS),
+                  K_MSEC(TACH_EMUL_CAPTURE_MS));
+    return 0;
+}
+
+static int tach_emul_disable_capture(const struct device* dev, uint32_t pwm)
+{
+    ARG_UNUSED(dev);
+
+    if (pwm >= ARRAY_SIZE(channels))
+    {
+        return -EINVAL;
+    }
+
+    k_timer_stop(&channels[pwm].timer);
+    return 0;
+}
+
+static int tach_emul_get_cycles_per_sec(const struct device* dev, uint32_t pwm,
+                                        uint64_t* cycles)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(pwm);
+
+    *cycles = TACH_EMUL_CYCLES_PER_SEC;
+    return 0;
+}
+
+static const struct pwm_driver_api tach_emul_api = {
+    .pin_set = tach_emul_pin_set,
+    .pin_configure_capture = tach_emul_configure_capture,
+    .pin_enable_capture = tach_emul_enable_capture,
+    .pin_disable_capture = tach_emul_disable_capture,
+    .get_cycles_per_sec = tach_emul_get_cycles_per_sec,
+};
+
+static int tach_emul_init(const struct device* dev)
+{
+    tach_emul_dev = dev;
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); ++i)
+    {
+        k_timer_init(&channels[i].timer, tach_emul_expiry, NULL);
+        k_timer_user_data_set(&channels[i].timer, &channels[i]);
+    }
+    return 0;
+}
+
+DEVICE_DEFINE(tach_emul, "TACH_EMUL", tach_emul_init, NULL, NULL, NULL,
+              POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &tach_emul_api);
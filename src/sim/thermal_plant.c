@@ -0,0 +1,396 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Simulated tray for native_posix.
+ *
+ * Closes the loop around the real thermal control: fan duty -> fan RPM ->
+ * airflow -> VR and HDD temperatures -> sensors. Fan RPM is read back through
+ * the emulated tach capture device, see tach_emul.c. Run with `-no-rt` to let
+ * virtual time go as fast as the host allows. At the end of the run a report
+ * with settling time, overshoot, duty oscillation and PID step cost is
+ * printed, the responses are checked against the
+ * CONFIG_SMC_THERMAL_SIM_MAX_* bounds and the process exits with the result.
+ */
+
+#include "pid_sched.h"
+#include "platform_cfg.h"
+#include "sensor_store.h"
+#include "thermal_sim.h"
+#include "topology.h"
+
+#include <kernel.h>
+#include <math.h>
+#include <posix_board_if.h>
+#include <shell/shell.h>
+#include <smc/pid.h>
+#include <smc/pid_sensor.h>
+#include <smc/sensor.h>
+#include <stdlib.h>
+
+#define SIM_DT (CONFIG_SMC_THERMAL_SIM_STEP_MS / 1000.0f)
+#define SIM_AMBIENT 25.0f
+#define SIM_FAN_MAX_RPM 12000.0f
+#define SIM_FAN_TAU 1.5f
+// A loop is settled when its temperature is within this band of the setpoint,
+// or below it with the loop output on its lower limit: it cannot cool less.
+#define SIM_SETTLE_BAND 1.0f
+#define SIM_MAX_OVERSHOOT (CONFIG_SMC_THERMAL_SIM_MAX_OVERSHOOT_DC / 10.0f)
+// Duty reversals smaller than this are not counted as oscillation.
+#define SIM_DUTY_REVERSAL_MIN 0.5f
+
+/**
+ * @brief Lumped thermal RC node cooled by one fan.
+ */
+struct sim_node
+{
+    uint32_t sensor;
+    uint8_t fan;
+    // J/K
+    float capacity;
+    // W/K without and in addition at full airflow.
+    float g_still;
+    float g_air;
+    // Power dissipated: fixed part plus a fraction of the tray power.
+    float p_fixed;
+    float p_share;
+
+    float temp;
+};
+
+// The VR node, then one node per drive, see sim_init_drives().
+#define SIM_NODE_VR 0
+#define SIM_NODE_N (1 + SMC_DRIVE_N)
+
+static struct sim_node nodes[SIM_NODE_N] = {
+    [SIM_NODE_VR] =
+        {
+            .sensor = SMC_SENSOR_TEMP,
+            .fan = SMC_FAN_0,
+            .capacity = 40.0,
+            .g_still = 0.4,
+            .g_air = 3.5,
+            .p_fixed = 0.0,
+            .p_share = 0.2,
+            .temp = 33.0,
+        },
+};
+
+static const struct sim_node sim_drive_node = {
+    .fan = SMC_FAN_1,
+    .capacity = 700.0,
+    .g_still = 0.1,
+    .g_air = 0.6,
+    .p_fixed = 6.0,
+    .p_share = 0.01,
+    .temp = 39.0,
+};
+
+/**
+ * @brief Add a node for every drive of the topology.
+ *
+ * The drives get slightly different airflow and power, so the hottest ones
+ * change with the fan speed like in a real tray.
+ */
+bool thermal_sim_owns_sensor(uint32_t sensor_id)
+{
+    if (sensor_id == SMC_SENSOR_POW || sensor_id == nodes[SIM_NODE_VR].sensor)
+    {
+        return true;
+    }
+    for (int i = 0; i < SMC_DRIVE_N; ++i)
+    {
+        if (sensor_id == topology_hdd_temp_sensors[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sim_init_drives(void)
+{
+    for (int i = 0; i < SMC_DRIVE_N; ++i)
+    {
+        struct sim_node* node = &nodes[SIM_NODE_VR + 1 + i];
+        int spread = i % 4;
+
+        *node = sim_drive_node;
+        node->sensor = topology_hdd_temp_sensors[i];
+        node->g_air -= 0.05f * spread;
+        node->p_fixed += 0.5f * spread;
+        node->temp += spread;
+    }
+}
+
+/**
+ * @brief Tray power profile, sorted by time.
+ */
+struct sim_power_step
+{
+    uint32_t at_s;
+    float watts;
+};
+
+static const struct sim_power_step power_profile[] = {
+    {.at_s = 0, .watts = 250.0},
+    {.at_s = 600, .watts = 450.0},
+    {.at_s = 2400, .watts = 250.0},
+};
+
+/**
+ * @brief Response of a loop to one power step.
+ */
+struct sim_response
+{
+    float overshoot;
+    // Last time the loop was out of the settling band, and whether it was
+    // settled at the last sample of the step.
+    float settled_at;
+    bool settled;
+};
+
+/**
+ * @brief Loops scored by the report.
+ *
+ * A loop is scored on the input of its last step, the variable it regulates:
+ * the VR temperature, and the mean of the hottest drives for the HDD loop.
+ */
+static const uint32_t scored[] = {
+    SMC_PID_CONTROL_VR,
+    SMC_PID_CONTROL_HDD,
+};
+
+static struct sim_response responses[ARRAY_SIZE(scored)]
+                                    [ARRAY_SIZE(power_profile)];
+
+static const uint32_t fan_duty_sensor[SMC_FAN_N] = {
+    [SMC_FAN_0] = SMC_SENSOR_DUTY_FAN,
+    [SMC_FAN_1] = SMC_SENSOR_DUTY_FAN1,
+};
+
+static struct
+{
+    float rpm;
+    float last_duty;
+    float last_delta;
+    float travel;
+    uint32_t reversals;
+} fans[SMC_FAN_N];
+
+static float power_override = -1.0f;
+
+static float sim_power(float t, size_t* step)
+{
+    size_t i = 0;
+    while (i + 1 < ARRAY_SIZE(power_profile) &&
+           t >= power_profile[i + 1].at_s)
+    {
+        i++;
+    }
+    *step = i;
+    return (power_override >= 0.0f) ? power_override : power_profile[i].watts;
+}
+
+static void sim_fans(void)
+{
+    for (int i = 0; i < SMC_FAN_N; ++i)
+    {
+        float duty = readSensor(fan_duty_sensor[i]);
+        float target = (duty / 100.0f) * SIM_FAN_MAX_RPM;
+        fans[i].rpm += (target - fans[i].rpm) * (SIM_DT / SIM_FAN_TAU);
+
+        float delta = duty - fans[i].last_duty;
+        if (fabsf(delta) >= SIM_DUTY_REVERSAL_MIN)
+        {
+            if (delta * fans[i].last_delta < 0.0f)
+            {
+                fans[i].reversals++;
+            }
+            fans[i].last_delta = delta;
+        }
+        fans[i].travel += fabsf(delta);
+        fans[i].last_duty = duty;
+    }
+}
+
+float thermal_sim_fan_rpm(uint32_t fan)
+{
+    return (fan < SMC_FAN_N) ? fans[fan].rpm : 0.0f;
+}
+
+static void sim_nodes(float power)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(nodes); ++i)
+    {
+        struct sim_node* node = &nodes[i];
+        float airflow = fans[node->fan].rpm / SIM_FAN_MAX_RPM;
+        float g = node->g_still + node->g_air * powf(airflow, 0.8f);
+        float heat = node->p_fixed + (node->p_share * power);
+
+        node->temp +=
+            (heat - g * (node->temp - SIM_AMBIENT)) * SIM_DT / node->capacity;
+        set_sensor_reading_float(node->sensor, node->temp);
+        sensor_store_update(node->sensor, node->temp);
+    }
+}
+
+static void sim_score(float t, size_t step)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(scored); ++i)
+    {
+        struct pid_sched_params params;
+        struct pid_sched_stats stats;
+        if (pid_sched_get_params(scored[i], &params) != 0 ||
+            pid_sched_get_stats(scored[i], &stats) != 0 || stats.steps == 0)
+        {
+            continue;
+        }
+
+        struct sim_response* r = &responses[i][step];
+        float over = stats.input - params.setpoint;
+
+        r->overshoot = MAX(r->overshoot, over);
+        r->settled = fabsf(over) <= SIM_SETTLE_BAND ||
+                     (over < 0.0f && stats.output_at_min);
+        if (!r->settled)
+        {
+            r->settled_at = t;
+        }
+    }
+}
+
+/**
+ * @brief Print the report.
+ *
+ * @return true if every response is within the configured bounds.
+ */
+static bool sim_report(void)
+{
+    bool pass = true;
+
+    printk("thermal_sim: report\n");
+    for (size_t i = 0; i < ARRAY_SIZE(scored); ++i)
+    {
+        struct pid_sched_stats stats;
+        pid_sched_get_stats(scored[i], &stats);
+
+        uint32_t avg_ns = (stats.steps != 0)
+                              ? (uint32_t)(stats.total_step_ns / stats.steps)
+                              : 0;
+        printk("  loop %u: %u steps, step cost avg %u ns max %u ns\n",
+               scored[i], stats.steps, avg_ns, stats.max_step_ns);
+
+        for (size_t s = 0; s < ARRAY_SIZE(power_profile); ++s)
+        {
+            const struct sim_response* r = &responses[i][s];
+            float overshoot = MAX(r->overshoot, 0.0f);
+            float settling = (r->settled_at > power_profile[s].at_s)
+                                 ? r->settled_at - power_profile[s].at_s
+                                 : 0.0f;
+            bool ok = r->settled && overshoot <= SIM_MAX_OVERSHOOT &&
+                      settling <= CONFIG_SMC_THERMAL_SIM_MAX_SETTLING_S;
+
+            printk("    step %u (%.0f W @ %us): overshoot %.2f C, "
+                   "settling %.1f s%s%s\n",
+                   (uint32_t)s, (double)power_profile[s].watts,
+                   power_profile[s].at_s, (double)overshoot,
+                   (double)settling, r->settled ? "" : ", not settled",
+                   ok ? "" : " <- out of bounds");
+            pass = pass && ok;
+        }
+    }
+
+    for (int i = 0; i < SMC_FAN_N; ++i)
+    {
+        printk("  fan %d: duty travel %.1f %%, %u reversals\n", i,
+               (double)fans[i].travel, fans[i].reversals);
+    }
+
+    printk("thermal_sim: %s (overshoot <= %.1f C, settling <= %u s)\n",
+           pass ? "PASS" : "FAIL", (double)SIM_MAX_OVERSHOOT,
+           CONFIG_SMC_THERMAL_SIM_MAX_SETTLING_S);
+    return pass;
+}
+
+static void thermal_sim_run(void* p1, void* p2, void* p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    const uint32_t steps = (CONFIG_SMC_THERMAL_SIM_DURATION_S * 1000) /
+                           CONFIG_SMC_THERMAL_SIM_STEP_MS;
+
+    sim_init_drives();
+    for (int i = 0; i < SMC_FAN_N; ++i)
+    {
+        fans[i].last_duty = readSensor(fan_duty_sensor[i]);
+    }
+
+    for (uint32_t n = 0; n < steps; ++n)
+    {
+        float t = n * SIM_DT;
+        size_t step;
+        float power = sim_power(t, &step);
+
+        set_sensor_reading_float(SMC_SENSOR_POW, power);
+        sensor_store_update(SMC_SENSOR_POW, power);
+        sim_fans();
+        sim_nodes(power);
+        sim_score(t, step);
+
+        k_msleep(CONFIG_SMC_THERMAL_SIM_STEP_MS);
+    }
+
+    posix_exit(sim_report() ? 0 : 1);
+}
+
+K_THREAD_DEFINE(thermal_sim, 2048, thermal_sim_run, NULL, NULL, NULL,
+                K_PRIO_PREEMPT(CONFIG_SMC_PID_SCHED_THREAD_PRIORITY + 1), 0,
+                0);
+
+static int cmd_thermal_sim_report(const struct shell* shell, size_t argc,
+                                  char** argv)
+{
+    ARG_UNUSED(shell);
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    (void)sim_report();
+    return 0;
+}
+
+static int cmd_thermal_sim_power(const struct shell* shell, size_t argc,
+                                 char** argv)
+{
+    ARG_UNUSED(argc);
+
+    power_override = strtof(argv[1], NULL);
+    shell_print(shell, "Tray power forced to %.1f W (negative: profile)",
+                (double)power_override);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_thermal_sim,
+    SHELL_CMD(report, NULL, "Print the control loop report",
+              cmd_thermal_sim_report),
+    SHELL_CMD_ARG(power, NULL, "Force the tray power <W>",
+                  cmd_thermal_sim_power, 2, 0),
+    SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(thermal_sim, &sub_thermal_sim, "Simulated tray commands",
+                   NULL);
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THERMAL_SIM_H_
+#define THERMAL_SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Current speed of a simulated fan, in RPM.
+ */
+float thermal_sim_fan_rpm(uint32_t fan);
+
+/**
+ * @brief Whether the simulator publishes a sensor.
+ *
+ * The simulator is the only writer of the tray power and of the temperatures
+ * it models, they must not be polled as dummy sensors.
+ */
+bool thermal_sim_owns_sensor(uint32_t sensor_id);
+
+#endif /* THERMAL_SIM_H_ */
@@ -14,9 +14,17 @@
  * limitations under the License.
  */
 
+#include "drive_temp.h"
+#include "fan_rpm_ctl.h"
+#include "fan_zone.h"
+#include "pid_sched.h"
+#include "platform.h"
 #include "platform_cfg.h"
+#include "sensor_store.h"
+#include "topology.h"
 
 #include <init.h>
+#include <kernel.h>
 #include <logging/log.h>
 #include <shell/shell.h>
 #include <smc/fan_sensor.h>
@@ -48,16 +56,42 @@ const float kIntegral_Max = kOutput_Max;
 // 1 minute start phase
 const int kStartPhaseInSec = (1 * 60);
 
+// A control input older than this has missed several 1 s polls and is
+// treated as lost.
+#define SENSOR_MAX_AGE_MS 5000
+
+// VR temperature seen by its loop while the sensor is lost. Far above the
+// setpoint so the loop ramps the fans.
+const float kVrTempFailSafe = 125.0;
+
 LOG_MODULE_REGISTER(smc_thermal_config);
 
 static void setOutputTable(uint32_t ctx, float value);
+static void feedForwardHdl(void);
+static float fsmLoopInput(uint32_t ctx);
+static void discardFsmOutput(uint32_t ctx, float value);
 static void smcPostProc(void);
-static float getHddAvgTemp(uint32_t);
+static float getVrTemp(uint32_t);
+static float getHddTemp(uint32_t);
 
 //===========================================
 
-static float outputTable[SMC_CLOSED_LOOP_PID_CNT]; // pid output storage (one
-                                                   // per pid loop)
+// Feed-forward requests are arbitrated with the PID outputs and stored after
+// them in outputTable.
+enum smc_ff_request
+{
+    SMC_FF_REQUEST_POWER = SMC_CLOSED_LOOP_PID_CNT,
+
+    SMC_THERMAL_REQUEST_N,
+};
+
+static float outputTable[SMC_THERMAL_REQUEST_N]; // pid and feed-forward output
+                                                 // storage (one per request)
+
+static uint32_t outputValidMask; // bit per outputTable entry written since
+                                 // boot
+
+static int64_t start_phase_end_ms; // uptime at which the start phase ends
 
 //---------------
 // SMC thermal control descriptors
@@ -81,8 +115,8 @@ pid_desc_t smcPidDesc[] = {
             .namePtr = "VRs",
             .localSetpoint = 66.0,
             .setpt = getter(localSetptHdlr, SMC_PID_CONTROL_VR),
-            .input = getter(readSensor, SMC_SENSOR_TEMP),
-            .output = setter(setOutputTable, SMC_PID_CONTROL_VR),
+            .input = getter(fsmLoopInput, SMC_PID_CONTROL_VR),
+            .output = setter(discardFsmOutput, SMC_PID_CONTROL_VR),
 
             .info =
                 {
@@ -106,8 +140,8 @@ pid_desc_t smcPidDesc[] = {
             .namePtr = "HDD",
             .localSetpoint = 48.0,
             .setpt = getter(localSetptHdlr, SMC_PID_CONTROL_HDD),
-            .input = getter(getHddAvgTemp, 0),
-            .output = setter(setOutputTable, SMC_PID_CONTROL_HDD),
+            .input = getter(fsmLoopInput, SMC_PID_CONTROL_HDD),
+            .output = setter(discardFsmOutput, SMC_PID_CONTROL_HDD),
             .info =
                 {
                     .enabled = kPid_Def_Enable,
@@ -131,70 +165,263 @@ pid_desc_t smcPidDesc[] = {
     },
 };
 
+//---------------
+// HDD temperature aggregation
+//   - Mean of the hottest drives, so one hot drive in a large enclosure is
+//     not averaged away. Powered off, absent and stale drives are skipped;
+//     a reading is stale after missing several 1 s polls.
+//   - With drives powered on but none usable the HDD loop sees the upper
+//     bound of a valid reading and runs the fans at full duty: a blind loop
+//     fails safe. With every drive powered off it sees a cold tray and
+//     leaves the fans to the other loops.
+//
+
+static const struct drive_temp_cfg hddTempCfg = {
+    .sensors = topology_hdd_temp_sensors,
+    .drive_count = SMC_DRIVE_N,
+    .policy = DRIVE_TEMP_POLICY_TOP_K_MEAN,
+    .top_k = 2,
+    .valid_min = 1.0,
+    .valid_max = 100.0,
+    .max_age_ms = SENSOR_MAX_AGE_MS,
+    .fallback = 100.0,
+    .idle = 0.0,
+};
+
+//---------------
+// Tray power feed-forward
+//   - Tray power leads the temperature rise by seconds (VR) to minutes (HDD).
+//     Map it to the duty that power needs at steady state and use it as an
+//     extra request, so fans ramp on a power step before the loops react.
+//   - Linear interpolation between points, sorted by power.
+//   - On a power drop the request decays at ffDecayPerSec to let the
+//     feedback loops take over without an airflow dip.
+//
+struct ffCurvePoint
+{
+    float power; // W
+    float duty;  // %
+};
+
+static const struct ffCurvePoint ffPowerCurve[] = {
+    {.power = 0.0, .duty = FAN_OUTPUT_MIN},
+    {.power = 200.0, .duty = FAN_OUTPUT_MIN},
+    {.power = 350.0, .duty = 45.0},
+    {.power = 500.0, .duty = 70.0},
+};
+
+const float ffDecayPerSec = 0.5; // % per second
+
+//---------------
+// Loop inputs, periods and parameter limits for pid_sched. A period of 0 uses
+// the descriptor's ts.
+//   - Setpoints are limited to the range of the sensor the loop regulates,
+//     see topology/tray.json.
+//   - The loops cool, so gains are negative or zero: a temperature above the
+//     setpoint must raise the duty. A gain beyond the whole output span per
+//     degree saturates the loop on any error, so it is the lower bound.
+//
+#define PID_GAIN_MIN (-(FAN_OUTPUT_MAX - FAN_OUTPUT_MIN))
+#define PID_GAIN_MAX 0.0
+#define PID_GAIN_LIMITS(bound) .kP = bound, .kI = bound, .kD = bound
+
+static const struct pid_sched_cfg smcPidSchedCfg[SMC_CLOSED_LOOP_PID_CNT] = {
+    // VR temperature moves within a second, so run it faster than the
+    // descriptor's 1 s ts allows.
+    [SMC_PID_CONTROL_VR] =
+        {
+            .input = getter(getVrTemp, 0),
+            .period_ms = 250,
+            .params_min = {.setpoint = 5.0, PID_GAIN_LIMITS(PID_GAIN_MIN)},
+            .params_max = {.setpoint = 80.0, PID_GAIN_LIMITS(PID_GAIN_MAX)},
+        },
+    // Drives heat slowly. Recompute as soon as a drive moved by half a
+    // degree, and at least every ts otherwise.
+    [SMC_PID_CONTROL_HDD] =
+        {
+            .input = getter(getHddTemp, 0),
+            .period_ms = 0,
+            .event_delta = 0.5,
+            .event_sensors = topology_hdd_temp_sensors,
+            .event_sensor_count = SMC_DRIVE_N,
+            .params_min = {.setpoint = 10.0, PID_GAIN_LIMITS(PID_GAIN_MIN)},
+            .params_max = {.setpoint = 70.0, PID_GAIN_LIMITS(PID_GAIN_MAX)},
+        },
+};
+
+//---------------
+// SMC fan zones
+//   - Each zone arbitrates the outputTable entries of its own loops and
+//     drives its own fans. A fan listed in several zones runs at the highest
+//     of their requests.
+//
+static const uint8_t vrZoneLoops[] = {SMC_PID_CONTROL_VR,
+                                      SMC_FF_REQUEST_POWER};
+static const uint8_t vrZoneFans[] = {SMC_FAN_0};
+
+static const uint8_t hddZoneLoops[] = {SMC_PID_CONTROL_HDD, SMC_PID_CONTROL_VR,
+                                       SMC_FF_REQUEST_POWER};
+static const uint8_t hddZoneFans[] = {SMC_FAN_1};
+
+static const struct fan_zone smcFanZones[] = {
+    {
+        .name = "VRs",
+        .policy = FAN_ZONE_POLICY_MAX,
+        .loops = vrZoneLoops,
+        .loop_count = ARRAY_SIZE(vrZoneLoops),
+        .fans = vrZoneFans,
+        .fan_count = ARRAY_SIZE(vrZoneFans),
+    },
+    {
+        .name = "HDD",
+        .policy = FAN_ZONE_POLICY_MAX,
+        .loops = hddZoneLoops,
+        .loop_count = ARRAY_SIZE(hddZoneLoops),
+        .fans = hddZoneFans,
+        .fan_count = ARRAY_SIZE(hddZoneFans),
+    },
+};
+
 //-----------------------
 // object export
+//
+// smc-common keeps owning the descriptors (parameters, mode and shell) but
+// loop evaluation and fan updates are driven by pid_sched. smc-common has no
+// way to stop the periodic sweep of its FSM, so the sweep is made inert: it
+// reads the inputs pid_sched already sampled and its outputs are dropped.
 const thermal_ctl_t smc_thermal_ctl = {
     .descPtr = &smcPidDesc[0],
     .postProc = smcPostProc,
 };
 
 //------------------------
-// getHddMaxTemp - get the average HDD temperature
-static float getHddAvgTemp(uint32_t)
+// getVrTemp - get the VR temperature, failing hot if the sensor is lost
+static float getVrTemp(uint32_t)
+{
+    return sensor_store_value_or(SMC_SENSOR_TEMP, SENSOR_MAX_AGE_MS,
+                                 kVrTempFailSafe);
+}
+
+//------------------------
+// getHddTemp - get the aggregated HDD temperature
+static float getHddTemp(uint32_t)
+{
+    return drive_temp_aggregate(&hddTempCfg);
+}
+
+//------------------------
+// ffPowerDuty - interpolate ffPowerCurve
+static float ffPowerDuty(float power)
 {
-    float hdd0 = readSensor(SMC_SENSOR_HDD0_TEMP);
-    float hdd1 = readSensor(SMC_SENSOR_HDD1_TEMP);
+    const int last = ARRAY_SIZE(ffPowerCurve) - 1;
 
-    return (hdd0 + hdd1) / 2.0;
+    if (power <= ffPowerCurve[0].power)
+        return ffPowerCurve[0].duty;
+    if (power >= ffPowerCurve[last].power)
+        return ffPowerCurve[last].duty;
+
+    int i = 1;
+    while (power > ffPowerCurve[i].power)
+        i++;
+
+    const struct ffCurvePoint* lo = &ffPowerCurve[i - 1];
+    const struct ffCurvePoint* hi = &ffPowerCurve[i];
+    return lo->duty + (power - lo->power) * (hi->duty - lo->duty) /
+                          (hi->power - lo->power);
 }
 
 //------------------------
-// pidHdl - Get max value from PIDs
-static void pidHdl(float* maxPtr)
+// feedForwardHdl - update the feed-forward requests in outputTable
+static void feedForwardHdl(void)
 {
-    *maxPtr = 0;
-    // find max value of requests
+    static int64_t lastMs;
+    int64_t nowMs = k_uptime_get();
+    float dt = (lastMs != 0) ? (nowMs - lastMs) / 1000.0f : 0.0f;
+    lastMs = nowMs;
+
+    // A lost power sensor requests the duty of the highest tray power.
+    float power = sensor_store_value_or(
+        SMC_SENSOR_POW, SENSOR_MAX_AGE_MS,
+        ffPowerCurve[ARRAY_SIZE(ffPowerCurve) - 1].power);
+    float target = ffPowerDuty(power);
+    float current = outputTable[SMC_FF_REQUEST_POWER];
+
+    // Rise immediately, fall slowly.
+    if ((outputValidMask & BIT(SMC_FF_REQUEST_POWER)) &&
+        (target < current - ffDecayPerSec * dt))
+    {
+        target = current - ffDecayPerSec * dt;
+    }
+
+    outputTable[SMC_FF_REQUEST_POWER] = target;
+    outputValidMask |= BIT(SMC_FF_REQUEST_POWER);
+}
+
+//------------------------
+// pidHdl - Arbitrate PID and feed-forward requests into a duty per fan
+static void pidHdl(float* fanDuty)
+{
+    // Feed-forward requests are always enabled.
+    uint32_t enabledMask = BIT(SMC_FF_REQUEST_POWER);
     for (int i = 0; i < SMC_CLOSED_LOOP_PID_CNT; i++)
     {
         if (smcPidDesc[i].info.enabled)
         {
-            if (*maxPtr < outputTable[i])
-                *maxPtr = outputTable[i];
+            enabledMask |= BIT(i);
         }
     }
+
+    fan_zone_arbitrate(smcFanZones, ARRAY_SIZE(smcFanZones), outputTable,
+                       enabledMask & outputValidMask, kOutput_Min_Post,
+                       fanDuty, SMC_FAN_N);
 }
 
 //------------------------
-// smcPostProc - Post thermal control calcuation callback (once a second)
-//   - This routine is called after the PID FSM completes process of the
-//     thermal descriptor.
+// smcPostProc - smc-common FSM post process callback (once a second)
+//   - Loop outputs are produced by pid_sched, so there is nothing left to do
+//     on the fixed sweep.
+//
+static void smcPostProc(void) {}
+
+//------------------------
+// fanUpdate - Post thermal control calcuation (after every pid_sched step)
 //   - Any post process is done here.
 //     - Implement start phase
-//     - Get PID/bmc max request
-//     - Update FAN pwm sensors for FAN driver
+//     - Update feed-forward requests
+//     - Arbitrate PID and feed-forward requests per fan zone
+//     - Hand the requests to the per fan RPM loops
 //
-static void smcPostProc(void)
+static void fanUpdate(void)
 {
-    float max = kOutput_Min_Post;
-    static int start_phase_timer_sec = kStartPhaseInSec;
+    float fanDuty[SMC_FAN_N];
+
+    // Fans are owned by the host while in manual mode.
+    int mode = thermalControlConfig();
+    if ((mode == KTHERMAL_CONTROLS_NOT_CONFIGURED) ||
+        (mode == KTHERMAL_CONTROLS_MANUAL))
+    {
+        return;
+    }
 
     // handle start phase
-    if (start_phase_timer_sec > 0)
-        start_phase_timer_sec -= 1;
-    if (start_phase_timer_sec > 0)
+    if (k_uptime_get() < start_phase_end_ms)
     {
-        writeSensor(SMC_SENSOR_DUTY_FAN, kOutput_Start);
+        for (int fan = 0; fan < SMC_FAN_N; fan++)
+        {
+            fanDuty[fan] = kOutput_Start;
+        }
     }
     else
     {
-        pidHdl(&max);
-        writeSensor(SMC_SENSOR_DUTY_FAN, max);
+        feedForwardHdl();
+        pidHdl(fanDuty);
     }
 
-    // drive fans to lastest settings. But no fans are connected or configured.
-    // int ret = fan_set_duty_by_id(/*fan_index=*/0, max);
-    // if (ret != 0)
-    //         printk("  Set Fan PWM%d:%d %f\n", fan_index, ret, percent);
+    // drive fans to lastest settings
+    for (int fan = 0; fan < SMC_FAN_N; fan++)
+    {
+        fan_rpm_ctl_set_target(fan, fanDuty[fan]);
+    }
 }
 
 //------------------------
@@ -206,11 +433,50 @@ static void smcPostProc(void)
 static void setOutputTable(uint32_t index, float value)
 {
     outputTable[index] = value;
+    outputValidMask |= BIT(index);
+    fanUpdate();
+}
+
+//------------------------
+// fsmLoopInput - input handler seen by the smc-common FSM. Returns the input
+//   last sampled by pid_sched instead of sampling the sensors again.
+//
+static float fsmLoopInput(uint32_t index)
+{
+    struct pid_sched_stats stats;
+    return (pid_sched_get_stats(index, &stats) == 0) ? stats.input : 0.0f;
+}
+
+//------------------------
+// discardFsmOutput - output handler seen by the smc-common FSM. Its fixed
+//   1 Hz results are ignored in favour of the pid_sched ones.
+//
+static void discardFsmOutput(uint32_t index, float value)
+{
+    ARG_UNUSED(index);
+    ARG_UNUSED(value);
 }
 
 //-------------------------
 int install_smc_thermal_ctl()
 {
     pidControlInit(&smc_thermal_ctl);
-    return 0;
+
+    int ret = fan_zone_validate(smcFanZones, ARRAY_SIZE(smcFanZones));
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    // After a watchdog reset with valid retained loop state, skip the start
+    // phase and resume from where the loops were.
+    bool resume = platform_wdt_reset_detected() &&
+                  pid_sched_can_resume(SMC_CLOSED_LOOP_PID_CNT);
+    if (!resume)
+    {
+        start_phase_end_ms = k_uptime_get() + (kStartPhaseInSec * 1000);
+    }
+
+    return pid_sched_start(smcPidDesc, smcPidSchedCfg, SMC_CLOSED_LOOP_PID_CNT,
+                           setOutputTable, resume);
 }
@@ -14,13 +14,24 @@
  * limitations under the License.
  */
 
+#include "platform.h"
+
 #include <kernel.h>
 #include <smc/wdt.h>
 #include <soc.h>
 
+#ifdef CONFIG_BOARD_NATIVE_POSIX_64BIT
+// There is no reset log on the host, every start is a cold boot.
+bool platform_wdt_reset_detected(void)
+{
+    return false;
+}
+#else
 #define SYS_WDT2_FULL_RESET BIT(21)
 #define SYS_WDT2_SOC_RESET BIT(20)
 
+static bool wdt_reset;
+
 /**
  * Watchdog reset module for the AST1030/AST1035 chip
  */
@@ -28,7 +39,6 @@ static int smc_wdt_init(const struct device* dev)
 {
     ARG_UNUSED(dev);
 
-    bool wdt_reset = false;
     uint32_t reset_logs = sys_read32(SYS_RESET_LOG_REG1);
     if ((reset_logs & SYS_WDT2_SOC_RESET) || (reset_logs & SYS_WDT2_FULL_RESET))
     {
@@ -44,3 +54,9 @@ static int smc_wdt_init(const struct device* dev)
                     NULL);
 }
 SYS_INIT(smc_wdt_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
+
+bool platform_wdt_reset_detected(void)
+{
+    return wdt_reset;
+}
+#endif /* CONFIG_BOARD_NATIVE_POSIX_64BIT */
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "poll_sched.h"
+
+#include <kernel.h>
+#include <ztest.h>
+
+#define TICK_MS CONFIG_SMC_POLL_SCHED_TICK_MS
+// Work items can run up to a system clock tick late.
+#define SLACK_MS (TICK_MS / 2)
+
+/**
+ * @brief Calls seen by one batch, passed as the batch context.
+ */
+struct poll_log
+{
+    uint32_t calls;
+    uint32_t first_ms;
+    uint32_t last_ms;
+    uint32_t min_interval_ms;
+    uint32_t max_interval_ms;
+    size_t count;
+    uint32_t sensors[4];
+};
+
+static void poll_record(const uint32_t* sensors, size_t count, void* ctx)
+{
+    struct poll_log* log = ctx;
+    uint32_t now_ms = k_uptime_get_32();
+
+    if (log->calls == 0)
+    {
+        log->first_ms = now_ms;
+        log->min_interval_ms = UINT32_MAX;
+    }
+    else
+    {
+        uint32_t interval = now_ms - log->last_ms;
+        log->min_interval_ms = MIN(log->min_interval_ms, interval);
+        log->max_interval_ms = MAX(log->max_interval_ms, interval);
+    }
+    log->calls++;
+    log->last_ms = now_ms;
+    log->count = count;
+    for (size_t i = 0; i < MIN(count, ARRAY_SIZE(log->sensors)); ++i)
+    {
+        log->sensors[i] = sensors[i];
+    }
+}
+
+// Batches created so far, the scheduler state is shared by all the tests.
+static size_t batches;
+
+static void test_invalid_args(void)
+{
+    static uint32_t ids[CONFIG_SMC_POLL_SCHED_BATCH_SIZE + 1];
+    static struct poll_log log;
+
+    zassert_equal(poll_sched_add(ids, 1, 0, poll_record, &log), -EINVAL,
+                  "period 0 accepted");
+    zassert_equal(poll_sched_add(ids, 0, 100, poll_record, &log), -EINVAL,
+                  "empty batch accepted");
+    zassert_equal(poll_sched_add(ids, ARRAY_SIZE(ids), 100, poll_record, &log),
+                  -EINVAL, "oversized batch accepted");
+    zassert_not_equal(poll_sched_add(NULL, 1, 100, poll_record, &log), 0,
+                      "NULL sensors accepted");
+    zassert_not_equal(poll_sched_add(ids, 1, 100, NULL, &log), 0,
+                      "NULL callback accepted");
+}
+
+static void test_stagger(void)
+{
+    static const uint32_t a = 1;
+    static const uint32_t b = 2;
+    static struct poll_log log_a;
+    static struct poll_log log_b;
+
+    // Same period but different contexts: two batches, which should not be
+    // polled on the same tick.
+    zassert_equal(poll_sched_add(&a, 1, 2 * TICK_MS, poll_record, &log_a), 0,
+                  NULL);
+    zassert_equal(poll_sched_add(&b, 1, 2 * TICK_MS, poll_record, &log_b), 0,
+                  NULL);
+    batches += 2;
+
+    k_msleep(20 * TICK_MS);
+
+    zassert_true(log_a.calls >= 9 && log_b.calls >= 9, "%u / %u calls",
+                 log_a.calls, log_b.calls);
+    zassert_within((log_b.first_ms - log_a.first_ms) % (2 * TICK_MS), TICK_MS,
+                   SLACK_MS, "batches share a tick");
+}
+
+static void test_period_rounding(void)
+{
+    static const uint32_t id = 3;
+    static struct poll_log log;
+
+    // Rounded up to three ticks.
+    zassert_equal(poll_sched_add(&id, 1, 2 * TICK_MS + 1, poll_record, &log),
+                  0, NULL);
+    batches++;
+
+    k_msleep(30 * TICK_MS);
+
+    zassert_within(log.calls, 10, 1, "%u calls", log.calls);
+    zassert_within(log.min_interval_ms, 3 * TICK_MS, SLACK_MS, NULL);
+    zassert_within(log.max_interval_ms, 3 * TICK_MS, SLACK_MS, NULL);
+}
+
+static void test_coalesce(void)
+{
+    static const uint32_t first[] = {4, 5};
+    static const uint32_t second = 6;
+    static struct poll_log log;
+
+    zassert_equal(poll_sched_add(first, ARRAY_SIZE(first), 4 * TICK_MS,
+                                 poll_record, &log),
+                  0, NULL);
+    // Same callback, context and period: joins the batch above.
+    zassert_equal(poll_sched_add(&second, 1, 4 * TICK_MS, poll_record, &log),
+                  0, NULL);
+    batches++;
+
+    k_msleep(20 * TICK_MS);
+
+    zassert_within(log.calls, 5, 1, "%u calls", log.calls);
+    zassert_within(log.min_interval_ms, 4 * TICK_MS, SLACK_MS,
+                   "batch polled twice");
+    zassert_equal(log.count, 3, "%zu sensors in the batch", log.count);
+    zassert_equal(log.sensors[0], 4, NULL);
+    zassert_equal(log.sensors[1], 5, NULL);
+    zassert_equal(log.sensors[2], 6, NULL);
+}
+
+static void test_late_work(void)
+{
+    static const uint32_t id = 8;
+    static struct poll_log log;
+
+    zassert_equal(poll_sched_add(&id, 1, 2 * TICK_MS, poll_record, &log), 0,
+                  NULL);
+    batches++;
+
+    k_msleep(10 * TICK_MS);
+    uint32_t before = log.calls;
+
+    // Hold the work item off for five periods. It then polls the batch once
+    // and skips the missed periods instead of replaying them in a burst.
+    k_sched_lock();
+    k_busy_wait(10 * TICK_MS * USEC_PER_MSEC);
+    k_sched_unlock();
+    k_msleep(TICK_MS / 2);
+
+    zassert_true(log.calls - before >= 1 && log.calls - before <= 2,
+                 "%u polls after a late run", log.calls - before);
+}
+
+static void test_out_of_batches(void)
+{
+    static const uint32_t id = 7;
+    static struct poll_log logs[CONFIG_SMC_POLL_SCHED_MAX_BATCHES];
+
+    // Distinct contexts, so every call needs a batch of its own.
+    size_t i = 0;
+    while (batches < CONFIG_SMC_POLL_SCHED_MAX_BATCHES)
+    {
+        zassert_equal(
+            poll_sched_add(&id, 1, 1000 * TICK_MS, poll_record, &logs[i++]),
+            0, NULL);
+        batches++;
+    }
+    zassert_equal(
+        poll_sched_add(&id, 1, 1000 * TICK_MS, poll_record, &logs[i]),
+        -ENOMEM, "more batches than CONFIG_SMC_POLL_SCHED_MAX_BATCHES");
+}
+
+void test_main(void)
+{
+    ztest_test_suite(poll_sched, ztest_unit_test(test_invalid_args),
+                     ztest_unit_test(test_stagger),
+                     ztest_unit_test(test_period_rounding),
+                     ztest_unit_test(test_coalesce),
+                     ztest_unit_test(test_late_work),
+                     ztest_unit_test(test_out_of_batches));
+    ztest_run_test_suite(poll_sched);
+}
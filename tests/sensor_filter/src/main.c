@@ -0,0 +1,165 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_filter.h"
+#include "topology_ids.h"
+
+#include <kernel.h>
+#include <ztest.h>
+
+// Q16.16 resolution of the filter chain.
+#define Q16_EPSILON (1.0f / 65536)
+
+static void install(const struct sensor_filter_cfg* cfg)
+{
+    zassert_equal(sensor_filter_init(cfg, 1), 0, "filter not installed");
+}
+
+static void test_unfiltered_sensor(void)
+{
+    static const struct sensor_filter_cfg cfg = {
+        .sensor_id = SMC_SENSOR_VOLTAGE,
+        .ema_shift = 1,
+    };
+    install(&cfg);
+
+    zassert_equal(sensor_filter_apply(SMC_SENSOR_CURRENT, 12.5f), 12.5f,
+                  "sensor without a chain must pass through");
+    zassert_equal(sensor_filter_apply(SMC_SENSOR_N, 1.0f), 1.0f,
+                  "out of range sensor must pass through");
+}
+
+static void test_median_drops_spike(void)
+{
+    static const struct sensor_filter_cfg cfg = {
+        .sensor_id = SMC_SENSOR_VOLTAGE,
+        .median_len = 3,
+    };
+    install(&cfg);
+
+    zassert_within(sensor_filter_apply(SMC_SENSOR_VOLTAGE, 12.0f), 12.0f,
+                   Q16_EPSILON, NULL);
+    zassert_within(sensor_filter_apply(SMC_SENSOR_VOLTAGE, 12.0f), 12.0f,
+                   Q16_EPSILON, NULL);
+    zassert_within(sensor_filter_apply(SMC_SENSOR_VOLTAGE, 40.0f), 12.0f,
+                   Q16_EPSILON, "single spike must not pass the median");
+    zassert_within(sensor_filter_apply(SMC_SENSOR_VOLTAGE, 12.5f), 12.5f,
+                   Q16_EPSILON, NULL);
+}
+
+static void test_ema_converges(void)
+{
+    static const struct sensor_filter_cfg cfg = {
+        .sensor_id = SMC_SENSOR_TEMP,
+        .ema_shift = 2,
+    };
+    install(&cfg);
+
+    zassert_within(sensor_filter_apply(SMC_SENSOR_TEMP, 20.0f), 20.0f,
+                   Q16_EPSILON, "first reading seeds the average");
+    zassert_within(sensor_filter_apply(SMC_SENSOR_TEMP, 24.0f), 21.0f,
+                   Q16_EPSILON, "average moves a quarter of the way");
+    zassert_within(sensor_filter_apply(SMC_SENSOR_TEMP, 25.0f), 22.0f,
+                   Q16_EPSILON, NULL);
+}
+
+static void test_ema_full_scale_step(void)
+{
+    static const struct sensor_filter_cfg cfg = {
+        .sensor_id = SMC_SENSOR_TEMP,
+        .ema_shift = 1,
+    };
+    install(&cfg);
+
+    // The difference of the two readings does not fit in Q16.16.
+    sensor_filter_apply(SMC_SENSOR_TEMP, -32767.0f);
+    zassert_within(sensor_filter_apply(SMC_SENSOR_TEMP, 32767.0f), 0.0f,
+                   Q16_EPSILON, "average wrapped around");
+    zassert_within(sensor_filter_apply(SMC_SENSOR_TEMP, 32767.0f), 16383.5f,
+                   Q16_EPSILON, NULL);
+}
+
+static void test_slew_limit(void)
+{
+    static const struct sensor_filter_cfg cfg = {
+        .sensor_id = SMC_SENSOR_POW,
+        .slew_rate = 10.0f,
+    };
+    install(&cfg);
+
+    sensor_filter_apply(SMC_SENSOR_POW, 100.0f);
+    k_msleep(1000);
+    // One tick of rounding in the sleep is allowed for.
+    zassert_within(sensor_filter_apply(SMC_SENSOR_POW, 300.0f), 110.0f, 0.1f,
+                   "output moved faster than the slew rate");
+    k_msleep(1000);
+    zassert_within(sensor_filter_apply(SMC_SENSOR_POW, 50.0f), 100.0f, 0.1f,
+                   "slew limit must apply downwards too");
+}
+
+static void test_reset_reseeds(void)
+{
+    static const struct sensor_filter_cfg cfg = {
+        .sensor_id = SMC_SENSOR_TEMP,
+        .ema_shift = 3,
+        .slew_rate = 1.0f,
+    };
+    install(&cfg);
+
+    sensor_filter_apply(SMC_SENSOR_TEMP, 20.0f);
+    sensor_filter_reset(SMC_SENSOR_TEMP);
+    zassert_within(sensor_filter_apply(SMC_SENSOR_TEMP, 60.0f), 60.0f,
+                   Q16_EPSILON, "reading after a reset must seed the chain");
+}
+
+static void test_invalid_cfg(void)
+{
+    static const struct sensor_filter_cfg bad[] = {
+        {
+            .sensor_id = SMC_SENSOR_N,
+        },
+        {
+            .sensor_id = SMC_SENSOR_TEMP,
+            .median_len = CONFIG_SMC_SENSOR_FILTER_MEDIAN_MAX + 1,
+        },
+        {
+            .sensor_id = SMC_SENSOR_TEMP,
+            .ema_shift = 16,
+        },
+        {
+            .sensor_id = SMC_SENSOR_TEMP,
+            .slew_rate = -1.0f,
+        },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(bad); ++i)
+    {
+        zassert_equal(sensor_filter_init(&bad[i], 1), -EINVAL,
+                      "entry %u accepted", (unsigned int)i);
+    }
+}
+
+void test_main(void)
+{
+    ztest_test_suite(sensor_filter, ztest_unit_test(test_unfiltered_sensor),
+                     ztest_unit_test(test_median_drops_spike),
+                     ztest_unit_test(test_ema_converges),
+                     ztest_unit_test(test_ema_full_scale_step),
+                     ztest_unit_test(test_slew_limit),
+                     ztest_unit_test(test_reset_reseeds),
+                     ztest_unit_test(test_invalid_cfg));
+    ztest_run_test_suite(sensor_filter);
+}